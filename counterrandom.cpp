@@ -0,0 +1,50 @@
+
+#include "counterrandom.h"
+
+#include <cstring>
+
+static const uint64_t golden = 0x9e3779b97f4a7c15ULL;
+
+static inline uint64_t mix(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+//the top 24 bits, which a float holds exactly
+
+static inline float toUnit(uint64_t bits)
+{
+    return float(bits >> 40) * (1.0f / 16777216.0f);
+}
+
+counterRandom::counterRandom(uint64_t seed) :
+    seed(seed)
+{
+}
+
+uint64_t counterRandom::seedFor(float startTime, int effectType)
+{
+    uint32_t timeBits;
+    memcpy(&timeBits, &startTime, sizeof (timeBits));
+    return mix((uint64_t(timeBits) << 32) ^ uint32_t(effectType));
+}
+
+uint64_t counterRandom::bits(uint64_t i) const
+{
+    return mix(seed + (i + 1) * golden);
+}
+
+float counterRandom::uniform(uint64_t i) const
+{
+    return toUnit(bits(i));
+}
+
+void counterRandom::fill(uint64_t first, size_t count, float *out) const
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        out[i] = toUnit(mix(seed + (first + i + 1) * golden));
+    }
+}
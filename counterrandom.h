@@ -0,0 +1,34 @@
+
+#ifndef COUNTERRANDOM_H
+#define COUNTERRANDOM_H
+
+#include <cstddef>
+#include <cstdint>
+
+//A counter-based random number generator: number i of a stream is a
+//hash (SplitMix64's finaliser) of the seed and i, so any number can be
+//had without the ones before it, there is no shared state to lock, and
+//a stream is the same on every run and platform. Each event seeds its
+//own stream from what it is, so its particles come out the same
+//whenever and wherever it is set up.
+class counterRandom {
+public:
+    explicit counterRandom(uint64_t seed);
+
+    //a seed for an event, from its start time and effect type
+    static uint64_t seedFor(float startTime, int effectType);
+
+    //number i as 64 random bits, or as a float in [0, 1)
+    uint64_t bits(uint64_t i) const;
+    float uniform(uint64_t i) const;
+
+    //numbers first to first + count - 1 as floats in [0, 1). No
+    //number depends on another, so the loop carries no state from
+    //one to the next and can be vectorised or split across threads.
+    void fill(uint64_t first, size_t count, float *out) const;
+
+private:
+    uint64_t seed;
+};
+
+#endif /* COUNTERRANDOM_H */
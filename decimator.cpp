@@ -0,0 +1,185 @@
+
+#include "decimator.h"
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DECIMATOR_SSE2 1
+#endif
+
+//the non-zero taps each side of the centre of one half-band stage
+static const int sideTaps = 12;
+//the Kaiser window's shape parameter
+static const double kaiserBeta = 7.0;
+
+//the zeroth order modified Bessel function of the first kind, which
+//the Kaiser window is made of
+
+static double bessel0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50; ++k)
+    {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+int decimator::supportedFactor(int factor)
+{
+    int supported = 1;
+    while (supported * 2 <= factor) supported *= 2;
+    return supported;
+}
+
+decimator::decimator(int factor, int channels) :
+    factor(supportedFactor(factor)),
+    channels(channels),
+    taps(sideTaps)
+{
+    //a half-band filter is the ideal low-pass at a quarter of the input
+    //rate, sin(pi x / 2) / (pi x), whose even taps are all zero; tap m
+    //of ours is at offset 2m + 1 from the centre
+    int half = 2 * sideTaps - 1;
+    double sum = 0.5;
+
+    for (int m = 0; m < sideTaps; ++m)
+    {
+        double x = 2 * m + 1;
+        double sinc = sin(M_PI * x / 2) / (M_PI * x);
+        double r = x / half;
+        double window = bessel0(kaiserBeta * sqrt(1.0 - r * r)) / bessel0(kaiserBeta);
+        taps[m] = float(sinc * window);
+        sum += 2 * taps[m];
+    }
+
+    //unity gain at DC
+    centre = float(0.5 / sum);
+    for (int m = 0; m < sideTaps; ++m)
+    {
+        taps[m] = float(taps[m] / sum);
+    }
+
+    for (int f = 1; f < this->factor; f *= 2)
+    {
+        stages.push_back(stage());
+    }
+
+    reset();
+}
+
+int decimator::getFactor() const
+{
+    return factor;
+}
+
+//each stage delays by its centre, 2 * sideTaps - 1 of its own input
+//frames, which are worth twice as many of the previous stage's
+
+int decimator::getLatency() const
+{
+    return (2 * sideTaps - 1) * (factor - 1);
+}
+
+void decimator::reset()
+{
+    for (size_t s = 0; s < stages.size(); ++s)
+    {
+        stages[s].lines.assign(channels, std::vector<float>(4 * sideTaps - 2, 0.0f));
+        stages[s].outputs.resize(channels);
+        stages[s].outputPointers.resize(channels);
+        stages[s].next = 2 * sideTaps - 1;
+    }
+}
+
+int decimator::process(const float *const *in, int count, float *const *out)
+{
+    if (stages.empty())
+    {
+        for (int c = 0; c < channels; ++c)
+        {
+            for (int i = 0; i < count; ++i) out[c][i] = in[c][i];
+        }
+        return count;
+    }
+
+    for (size_t s = 0; s + 1 < stages.size(); ++s)
+    {
+        stage &st = stages[s];
+        for (int c = 0; c < channels; ++c)
+        {
+            st.outputs[c].resize(count / 2 + 1);
+            st.outputPointers[c] = &st.outputs[c][0];
+        }
+        count = halve(st, in, count, &st.outputPointers[0]);
+        in = &st.outputPointers[0];
+    }
+
+    return halve(stages.back(), in, count, out);
+}
+
+//One half-band stage. Output r is centred on line[next + 2r + half],
+//where half = 2 * sideTaps - 1 is odd, so its centre tap falls on an
+//odd frame counting from next and all its other taps on even ones.
+//Splitting the line into those even and odd frames first makes the
+//frames each tap needs for consecutive outputs consecutive in memory:
+//
+//    y[r] = centre odds[r + S - 1]
+//         + sum over m < S of taps[m] (evens[r + S - 1 - m] + evens[r + S + m])
+//
+//with S = sideTaps, which is what lets four outputs be done at once.
+
+int decimator::halve(stage &s, const float *const *in, int count, float *const *out)
+{
+    int history = 4 * sideTaps - 2;
+    int outputs = (s.next < count ? (count - s.next + 1) / 2 : 0);
+
+    evens.resize(outputs + 2 * sideTaps - 1);
+    odds.resize(outputs + sideTaps - 1);
+
+    for (int c = 0; c < channels; ++c)
+    {
+        std::vector<float> &line = s.lines[c];
+        line.insert(line.end(), in[c], in[c] + count);
+
+        const float *from = &line[s.next];
+        for (size_t t = 0; t < evens.size(); ++t) evens[t] = from[2 * t];
+        for (size_t t = 0; t < odds.size(); ++t) odds[t] = from[2 * t + 1];
+
+        float *to = out[c];
+        int r = 0;
+
+#ifdef DECIMATOR_SSE2
+        const __m128 middle = _mm_set1_ps(centre);
+        for (; r + 4 <= outputs; r += 4)
+        {
+            __m128 acc = _mm_mul_ps(middle, _mm_loadu_ps(&odds[r + sideTaps - 1]));
+            for (int m = 0; m < sideTaps; ++m)
+            {
+                __m128 pair = _mm_add_ps(_mm_loadu_ps(&evens[r + sideTaps - 1 - m]),
+                                         _mm_loadu_ps(&evens[r + sideTaps + m]));
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(taps[m]), pair));
+            }
+            _mm_storeu_ps(to + r, acc);
+        }
+#endif
+
+        for (; r < outputs; ++r)
+        {
+            float acc = centre * odds[r + sideTaps - 1];
+            for (int m = 0; m < sideTaps; ++m)
+            {
+                acc += taps[m] * (evens[r + sideTaps - 1 - m] + evens[r + sideTaps + m]);
+            }
+            to[r] = acc;
+        }
+
+        line.erase(line.begin(), line.end() - history);
+    }
+
+    s.next += 2 * outputs - count;
+    return outputs;
+}
@@ -0,0 +1,57 @@
+
+#ifndef DECIMATOR_H
+#define DECIMATOR_H
+
+#include <vector>
+
+//Low-pass filters and downsamples a multi-channel stream by a power of
+//two, as a cascade of half-band stages that each halve the rate. Each
+//stage is a 47 tap Kaiser-windowed half-band FIR: every other tap but
+//the centre one is zero and the rest are symmetric, so an output sample
+//costs 12 multiplies, and only the outputs that are kept get computed.
+//The passband is flat to within 0.003 dB up to 0.8 of the new Nyquist
+//frequency and the stopband is 70 dB down from 1.2 of it; in between,
+//as with any half-band filter, some alias folds into the top fifth of
+//the new band (-12 dB at 1.05 of the new Nyquist, -22 dB at 1.1).
+//
+//Output frame j lines up with input frame j * factor: the filter's
+//delay of getLatency() input frames is taken up front, so the first
+//getLatency() input frames produce nothing and every factor frames
+//after that produce one. Feeding getLatency() frames of silence after
+//the end of the input flushes out the rest.
+class decimator {
+public:
+    //the largest power of two not above factor, which is what a
+    //decimator asked for factor actually decimates by
+    static int supportedFactor(int factor);
+
+    decimator(int factor, int channels);
+
+    int getFactor() const;
+    int getLatency() const;
+
+    //filter count frames of in (one buffer per channel) and write the
+    //decimated frames to out; returns how many were written
+    int process(const float *const *in, int count, float *const *out);
+
+    void reset();
+
+private:
+    struct stage {
+        std::vector<std::vector<float> > lines; //the last taps - 1 input frames, then new ones
+        std::vector<std::vector<float> > outputs; //what the stage hands to the next one
+        std::vector<float *> outputPointers;
+        int next; //index into the next input of the newest frame of the next output
+    };
+
+    int halve(stage &s, const float *const *in, int count, float *const *out);
+
+    int factor;
+    int channels;
+    float centre; //the centre tap
+    std::vector<float> taps; //the other non-zero taps on one side, nearest first
+    std::vector<stage> stages;
+    std::vector<float> evens, odds;
+};
+
+#endif /* DECIMATOR_H */
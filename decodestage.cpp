@@ -0,0 +1,268 @@
+
+#include "decodestage.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+//spin briefly, then sleep, while the other side catches up
+static void backoff(int &spins)
+{
+    if (++spins < 64)
+    {
+        std::this_thread::yield();
+    }
+    else
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+decodeStage::decodeStage(SNDFILE *sndfile, int channels, int blockSize,
+                         int stepSize, int decimation, int mixTo,
+                         int queueLength) :
+    sndfile(sndfile),
+    wav(0),
+    fileChannels(channels),
+    channels(channels),
+    blockSize(blockSize),
+    stepSize(stepSize),
+    filter(0),
+    position(0),
+    produced(0),
+    holding(false),
+    head(0),
+    tail(0),
+    finished(false),
+    stopping(false)
+{
+    start(decimation, mixTo, queueLength);
+}
+
+decodeStage::decodeStage(const mappedWav *wav, int blockSize, int stepSize,
+                         int decimation, int mixTo, int queueLength) :
+    sndfile(0),
+    wav(wav),
+    fileChannels(wav->getChannelCount()),
+    channels(wav->getChannelCount()),
+    blockSize(blockSize),
+    stepSize(stepSize),
+    filter(0),
+    position(0),
+    produced(0),
+    holding(false),
+    head(0),
+    tail(0),
+    finished(false),
+    stopping(false)
+{
+    start(decimation, mixTo, queueLength);
+}
+
+void decodeStage::start(int decimation, int mixTo, int queueLength)
+{
+    if (decimation > 1)
+    {
+        if (mixTo > 0 && mixTo < fileChannels) channels = mixTo;
+        filter = new decimator(decimation, channels);
+    }
+
+    input.resize(fileChannels);
+    blocks.resize(std::max(2, queueLength));
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        blocks[i] = new float*[channels];
+        for (int c = 0; c < channels; ++c)
+        {
+            blocks[i][c] = new float[blockSize + 2];
+        }
+    }
+
+    thread = std::thread(&decodeStage::run, this);
+}
+
+//reads count frames from the file into buffers, padding with zeros past
+//the end; returns how many came from the file, or -1 on error
+
+sf_count_t decodeStage::read(float *const *buffers, int count)
+{
+    sf_count_t got;
+
+    if (wav)
+    {
+        wav->read(position, count, buffers);
+        got = std::min(sf_count_t(count),
+                       std::max(sf_count_t(0), sf_count_t(wav->getFrameCount() - position)));
+    }
+    else
+    {
+        interleaved.resize(size_t(count) * fileChannels);
+        if ((got = sf_readf_float(sndfile, &interleaved[0], count)) < 0)
+        {
+            error = sf_strerror(sndfile);
+            return -1;
+        }
+        for (int c = 0; c < fileChannels; ++c)
+        {
+            float *out = buffers[c];
+            for (int j = 0; j < got; ++j)
+            {
+                out[j] = interleaved[j * fileChannels + c];
+            }
+            for (int j = got; j < count; ++j)
+            {
+                out[j] = 0.0f;
+            }
+        }
+    }
+
+    position += got;
+    return got;
+}
+
+//as read(), but count is in decimated frames and the return value is
+//how many of them line up with an input frame inside the file. Mixing
+//down comes first, since it's cheaper than filtering the channels it
+//gets rid of and the filter is linear.
+
+sf_count_t decodeStage::readDecimated(float *const *buffers, int count)
+{
+    int factor = filter->getFactor();
+    int needed = count * factor;
+    if (produced == 0) needed += filter->getLatency();
+
+    std::vector<float *> in(fileChannels);
+    for (int c = 0; c < fileChannels; ++c)
+    {
+        input[c].resize(needed);
+        in[c] = &input[c][0];
+    }
+
+    if (read(&in[0], needed) < 0) return -1;
+
+    if (channels == 1 && fileChannels > 1)
+    {
+        float *mix = in[0];
+        for (int c = 1; c < fileChannels; ++c)
+        {
+            const float *from = in[c];
+            for (int j = 0; j < needed; ++j) mix[j] += from[j];
+        }
+        for (int j = 0; j < needed; ++j) mix[j] /= fileChannels;
+    }
+
+    filter->process(&in[0], needed, buffers);
+
+    sf_count_t inside = (position + factor - 1) / factor - produced;
+    produced += count;
+    return std::min(sf_count_t(count), std::max(sf_count_t(0), inside));
+}
+
+void decodeStage::run()
+{
+    int overlapSize = blockSize - stepSize;
+    int finalStepsRemaining = std::max(1, (blockSize / stepSize) - 1);
+    unsigned long decoded = 0;
+
+    std::vector<float *> frame(channels);
+    std::vector<float *> at(channels);
+    for (int c = 0; c < channels; ++c) frame[c] = new float[blockSize];
+
+    do
+    {
+        int offset = 0;
+        int count = blockSize;
+
+        if ((blockSize != stepSize) && (decoded != 0))
+        {
+            //  shunt the existing data down and read the remainder.
+            for (int c = 0; c < channels; ++c)
+            {
+                memmove(frame[c], frame[c] + stepSize, overlapSize * sizeof (float));
+            }
+            offset = overlapSize;
+            count = stepSize;
+        }
+
+        for (int c = 0; c < channels; ++c) at[c] = frame[c] + offset;
+
+        sf_count_t got = (filter ? readDecimated(&at[0], count) : read(&at[0], count));
+        if (got < 0) break;
+        if (got != count) --finalStepsRemaining;
+
+        int spins = 0;
+        while (decoded - head.load(std::memory_order_acquire) >= blocks.size())
+        {
+            if (stopping.load(std::memory_order_relaxed)) break;
+            backoff(spins);
+        }
+        if (stopping.load(std::memory_order_relaxed)) break;
+
+        float **block = blocks[decoded % blocks.size()];
+        for (int c = 0; c < channels; ++c)
+        {
+            memcpy(block[c], frame[c], blockSize * sizeof (float));
+        }
+
+        tail.store(++decoded, std::memory_order_release);
+    }
+    while (finalStepsRemaining > 0);
+
+    for (int c = 0; c < channels; ++c) delete[] frame[c];
+    finished.store(true, std::memory_order_release);
+}
+
+float **decodeStage::next()
+{
+    unsigned long consumed = head.load(std::memory_order_relaxed);
+
+    //hand the block from the last call back to the decoder
+    if (holding)
+    {
+        head.store(++consumed, std::memory_order_release);
+        holding = false;
+    }
+
+    int spins = 0;
+    while (tail.load(std::memory_order_acquire) == consumed)
+    {
+        if (finished.load(std::memory_order_acquire))
+        {
+            //the decoder may have published one more before finishing
+            if (tail.load(std::memory_order_acquire) == consumed) return 0;
+            break;
+        }
+        backoff(spins);
+    }
+
+    holding = true;
+    return blocks[consumed % blocks.size()];
+}
+
+int decodeStage::getChannelCount() const
+{
+    return channels;
+}
+
+bool decodeStage::failed() const
+{
+    return finished.load(std::memory_order_acquire) && error != "";
+}
+
+std::string decodeStage::getError() const
+{
+    return failed() ? error : std::string();
+}
+
+decodeStage::~decodeStage()
+{
+    stopping.store(true, std::memory_order_relaxed);
+    if (thread.joinable()) thread.join();
+
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        for (int c = 0; c < channels; ++c) delete[] blocks[i][c];
+        delete[] blocks[i];
+    }
+    delete filter;
+}
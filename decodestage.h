@@ -0,0 +1,85 @@
+
+#ifndef DECODESTAGE_H
+#define DECODESTAGE_H
+
+#include <sndfile.h>
+
+#include "decimator.h"
+#include "mappedwav.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+//Decodes a sound file on its own thread, ahead of the analysis. Blocks
+//of blockSize frames, advancing stepSize frames at a time and
+//deinterleaved ready for Plugin::process, go into a fixed ring of
+//pre-allocated buffers. The ring is single-producer single-consumer and
+//lock-free; the decoder waits when all the buffers are full and the
+//analysis waits when they are all empty.
+//
+//Blocks follow the same stepping as reading the file in place would,
+//including the part-silent blocks after the end of the file. Frames
+//past the end are always zero.
+//
+//With a decimation factor above 1 the stream is run through a
+//decimator first, so blocks and steps count frames at the file's
+//sample rate divided by the factor and block k starts at input frame
+//k * stepSize * factor. A decimated stream can also be mixed down to
+//fewer channels before it is filtered, so that channels the plugin
+//would only average together aren't each filtered: to their mean for
+//one channel, as PluginChannelAdapter would, or else by dropping the
+//extra ones.
+class decodeStage {
+public:
+    //decoding starts straight away; the source must stay open until the
+    //decodeStage is destroyed. mixTo is the number of channels in the
+    //blocks, if decimating and fewer than the file has; 0 for all of them.
+    decodeStage(SNDFILE *sndfile, int channels, int blockSize, int stepSize,
+                int decimation = 1, int mixTo = 0, int queueLength = 8);
+    decodeStage(const mappedWav *wav, int blockSize, int stepSize,
+                int decimation = 1, int mixTo = 0, int queueLength = 8);
+
+    //the number of channels in each block
+    int getChannelCount() const;
+    virtual ~decodeStage();
+
+    //the next block, one buffer per channel, or null after the last one
+    //or a read error. The block stays valid until the following call.
+    float **next();
+
+    bool failed() const;
+    std::string getError() const;
+
+private:
+    decodeStage(const decodeStage &);
+    decodeStage &operator=(const decodeStage &);
+
+    void start(int decimation, int mixTo, int queueLength);
+    void run();
+    sf_count_t read(float *const *buffers, int count);
+    sf_count_t readDecimated(float *const *buffers, int count);
+
+    SNDFILE *sndfile;
+    const mappedWav *wav;
+    int fileChannels;
+    int channels; //in the blocks
+    int blockSize;
+    int stepSize;
+    decimator *filter;
+    long position; //input frames read from the file so far
+    long produced; //decimated frames written so far
+    std::vector<float> interleaved;
+    std::vector<std::vector<float> > input;
+    std::vector<float **> blocks;
+    bool holding;
+    std::string error;
+    std::atomic<unsigned long> head; //blocks consumed
+    std::atomic<unsigned long> tail; //blocks decoded
+    std::atomic<bool> finished;
+    std::atomic<bool> stopping;
+    std::thread thread;
+};
+
+#endif /* DECODESTAGE_H */
@@ -0,0 +1,73 @@
+
+#include "effecttable.h"
+
+//an event beyond each of these distances from the eye draws half the
+//particles it would before it; the fountains are about a hundred units
+//across and the sky dome is 4000 away
+static const float detailDistances[] = { 500, 1000, 2000 };
+static const int detailLevels = sizeof (detailDistances) / sizeof (detailDistances[0]);
+
+static float detailAt(float distance)
+{
+    float detail = 1;
+    for (int i = 0; i < detailLevels && distance > detailDistances[i]; i++)
+    {
+        detail *= 0.5f;
+    }
+    return detail;
+}
+
+effectTable::effectTable()
+{
+}
+
+void effectTable::add(int effectType, drawFunction draw, void *context)
+{
+    if (effectType < 0) return;
+    if (size_t(effectType) >= effects.size())
+    {
+        effect none = { 0, 0, std::vector<item>() };
+        effects.resize(effectType + 1, none);
+    }
+    effects[effectType].draw = draw;
+    effects[effectType].context = context;
+}
+
+void effectTable::draw(const std::vector<event> &events, size_t first,
+                       size_t last, float now, const viewFrustum *view)
+{
+    for (size_t i = 0; i < effects.size(); ++i)
+    {
+        effects[i].batch.clear();
+    }
+
+    for (size_t i = first; i < last; ++i)
+    {
+        const event &e = events[i];
+        if (e.startTime > now || e.endTime < now) continue;
+        if (e.effectType < 0 || size_t(e.effectType) >= effects.size()) continue;
+        if (!effects[e.effectType].draw) continue;
+
+        item it = { i, 1 };
+        GLfloat low[3], high[3];
+        if (view && e.getBounds(now, low, high))
+        {
+            if (!view->intersects(low, high)) continue;
+            it.detail = detailAt(view->distanceTo(low, high));
+        }
+        effects[e.effectType].batch.push_back(it);
+    }
+
+    for (size_t i = 0; i < effects.size(); ++i)
+    {
+        const effect &fx = effects[i];
+        if (fx.draw && !fx.batch.empty())
+        {
+            fx.draw(events, fx.batch, now, fx.context);
+        }
+    }
+}
+
+effectTable::~effectTable()
+{
+}
@@ -0,0 +1,62 @@
+
+#ifndef EFFECTTABLE_H
+#define EFFECTTABLE_H
+
+#include "event.h"
+#include "viewfrustum.h"
+
+#include <vector>
+
+//Draws a frame's events one effect type at a time. Each effect type
+//registers a routine that draws every playing event of that type in
+//one go, so it can set its GL state once for the lot instead of once
+//an event. draw() sorts the playing events into a batch per type,
+//reusing the batches' storage from frame to frame, and then calls each
+//routine that has something to draw. Types with no routine registered
+//aren't drawn.
+//
+//Given a view, draw() also leaves out events whose bounds are wholly
+//outside it, and asks for fewer particles from those further off:
+//half beyond each of the detail distances in effecttable.cpp.
+class effectTable {
+public:
+    //an event to draw, and the fraction of its particles worth drawing
+    //at its distance, 1 close up
+    struct item {
+        size_t index;
+        float detail;
+    };
+
+    //draws events[batch[0].index], events[batch[1].index], ... as they
+    //are at time now; all of them have the type the routine was
+    //registered for. context is whatever was passed to add(), as for
+    //SDL's userdata.
+    typedef void (*drawFunction)(const std::vector<event> &events,
+                                 const std::vector<item> &batch,
+                                 float now, void *context);
+
+    effectTable();
+    virtual ~effectTable();
+
+    //draw effectType's events with draw from now on
+    void add(int effectType, drawFunction draw, void *context);
+
+    //draw those of events[first, last) that are playing at now and,
+    //if view isn't 0, can be seen in it
+    void draw(const std::vector<event> &events, size_t first, size_t last,
+              float now, const viewFrustum *view);
+
+private:
+    effectTable(const effectTable &);
+    effectTable &operator=(const effectTable &);
+
+    struct effect {
+        drawFunction draw;
+        void *context;
+        std::vector<item> batch;
+    };
+
+    std::vector<effect> effects; //indexed by effect type
+};
+
+#endif /* EFFECTTABLE_H */
@@ -1,21 +1,40 @@
 
 #include "event.h"
 
-    float startTime, duration, endTime;
-    int effectType;
-    float currentX, currentZ;
-    float r, g, b;
-    
-    typedef struct{
-        GLfloat x,y,z;
-        GLfloat xaccel,yaccel,zaccel;
-    } particle;
-    
-    particle particleArray[1000];
-   
+#include "counterrandom.h"
+
+#include <vector>
+
+const float event::stepsPerSecond = 10.0;
+const float event::gravity = 0.01;
+
+float event::stepsSince(float startTime, float now)
+{
+    float steps = (now - startTime) * stepsPerSecond;
+    return steps > 0 ? steps : 0;
+}
+
+//the sum of stepping one step at a time, which is what the fountain
+//did once: after n steps the y velocity has fallen n times and y has
+//lost gravity * (0 + 1 + ... + n - 1)
+
+void event::fountainPosition(const particle &p, float steps, GLfloat *xyz)
+{
+    xyz[0] = p.x + p.xaccel * steps;
+    xyz[1] = p.y + p.yaccel * steps - gravity * steps * (steps - 1) * 0.5f;
+    xyz[2] = p.z + p.zaccel * steps;
+}
+
+size_t event::payloadSize(int effectType)
+{
+    return effectType == 1 ? 999 : 0;
+}
+
 //constructor
 event::event()
 {
+    currentX = 0;
+    currentZ = 0;
     startTime = 0.0;
     effectType = 1;
     duration = 0.5;
@@ -23,11 +42,16 @@ event::event()
     r = 1;
     b = 0;
     g = 0;
-    
+    launch = 0;
+    launchCount = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        lowVelocity[i] = highVelocity[i] = 0;
+    }
 }
 
 //constructor
-event::event(float sTime, int eType, float dur)
+event::event(float sTime, int eType, float dur, particle *payload)
 {
     startTime = sTime;
     effectType = eType;
@@ -35,6 +59,12 @@ event::event(float sTime, int eType, float dur)
     endTime = startTime + duration;
     currentX = 0;
     currentZ = 0;
+    launch = payload;
+    launchCount = payloadSize(effectType);
+    for (int i = 0; i < 3; i++)
+    {
+        lowVelocity[i] = highVelocity[i] = 0;
+    }
     
     if(effectType == 1)
     {
@@ -52,70 +82,82 @@ void event::setColour(float red, float blue, float green)
     g = green;
 }
 
-void event::eventAnimate()
+float event::getOriginX() const
 {
-    switch(effectType){
-    case 1: //fountain
-        percussionFountain();
-        break;
-    case 2:
-        //tempo
-        break;
-    case 3:
-        //zerocrossings {vocals}
-        //drawSpheres();
-        break;
-    }
+    return currentX;
 }
 
-void event::percussionFountain()
+float event::getOriginZ() const
 {
-    glColor3f(r,g,b);
-    //glPointSize(3);
-    
-    for(int i = 0; i < 999; i ++)
-    {
-        glBegin(GL_POINTS);
-            glVertex3f(particleArray[i].x,particleArray[i].y,particleArray[i].z);
-        glEnd;
-        
-        particleArray[i].x += particleArray[i].xaccel;
-        particleArray[i].y += particleArray[i].yaccel;
-        particleArray[i].z += particleArray[i].zaccel;
-        
-        particleArray[i].yaccel -= 0.01;
-    }
+    return currentZ;
 }
 
-void event::setupFountain()
+void event::getColour(float &red, float &green, float &blue) const
 {
-    for(int i = 0; i < 999; i++)
-    {
-        particleArray[i].x = currentX;
-        particleArray[i].z = currentZ;
-        particleArray[i].y = 0;
-        particleArray[i].xaccel = (myRandom()-0.5)*2;
-        particleArray[i].yaccel = myRandom()*1.3;
-        particleArray[i].zaccel = (myRandom()-0.5)*2;
-    }
-    
+    red = r;
+    green = g;
+    blue = b;
 }
 
-void event::drawSpheres()
+const event::particle *event::getLaunch() const
 {
-    glColor3f(r,g,b);
-    glutSolidSphere(20,10,10);
+    return launch;
 }
 
-float event::myRandom()
-//Return random double within range [0,1]
+size_t event::getLaunchCount() const
 {
-  return (rand()/(float)RAND_MAX);
+    return launchCount;
 }
 
-//destructor
-event::~event()
+//every particle starts at the origin and falls by the same amount, so
+//after n steps the fountain spans the launch velocities times n on
+//each axis, with y lowered by the fall
+
+bool event::getBounds(float now, GLfloat *low, GLfloat *high) const
 {
-    
+    if (effectType != 1 || launchCount == 0) return false;
+
+    float steps = stepsSince(startTime, now);
+    float fall = gravity * steps * (steps - 1) * 0.5f;
+    const GLfloat origin[3] = { GLfloat(currentX), 0, GLfloat(currentZ) };
+
+    for (int i = 0; i < 3; i++)
+    {
+        low[i] = origin[i] + lowVelocity[i] * steps;
+        high[i] = origin[i] + highVelocity[i] * steps;
+    }
+    low[1] -= fall;
+    high[1] -= fall;
+    return true;
 }
 
+//the particles' launch velocities come from the event's own random
+//stream, three numbers a particle, so a fountain is the same on every
+//run and can be set up on any thread
+
+void event::setupFountain()
+{
+    counterRandom random(counterRandom::seedFor(startTime, effectType));
+    std::vector<float> u(launchCount * 3);
+    random.fill(0, u.size(), &u[0]);
+
+    for(size_t i = 0; i < launchCount; i++)
+    {
+        launch[i].x = currentX;
+        launch[i].z = currentZ;
+        launch[i].y = 0;
+        launch[i].xaccel = (u[i * 3]-0.5)*2;
+        launch[i].yaccel = u[i * 3 + 1]*1.3;
+        launch[i].zaccel = (u[i * 3 + 2]-0.5)*2;
+    }
+
+    for(size_t i = 0; i < launchCount; i++)
+    {
+        const GLfloat v[3] = { launch[i].xaccel, launch[i].yaccel, launch[i].zaccel };
+        for (int j = 0; j < 3; j++)
+        {
+            if (i == 0 || v[j] < lowVelocity[j]) lowVelocity[j] = v[j];
+            if (i == 0 || v[j] > highVelocity[j]) highVelocity[j] = v[j];
+        }
+    }
+}
@@ -6,21 +6,60 @@
 #include <GL/glut.h>
 #include <SDL2/SDL.h>
 
+#include <cstddef>
+
 class event {
 public:
+    //a fountain particle's position and its velocity per step
+    typedef struct{
+        GLfloat x,y,z;
+        GLfloat xaccel,yaccel,zaccel;
+    } particle;
+
+    //fountain particles move at stepsPerSecond steps a second, the
+    //frame rate display() ran at when the fountain was tuned, with
+    //their y velocity falling by gravity each step
+    static const float stepsPerSecond;
+    static const float gravity;
+
+    //the steps a fountain started at startTime has taken by now
+    static float stepsSince(float startTime, float now);
+
+    //where a particle launched as p is after steps steps: a pure
+    //function, so any frame can be drawn without the ones before it
+    static void fountainPosition(const particle &p, float steps, GLfloat *xyz);
+
+    //the particles an event of this type needs from its payload
+    static size_t payloadSize(int effectType);
+
     float startTime, duration, endTime;
     int effectType;
     event();
-    event(float sTime, int eType, float dur);
+    //payload is where the event keeps its particles: room for
+    //payloadSize(eType) of them, owned by the caller and outliving the
+    //event. Events are plain values, copied about freely, so they never
+    //own memory themselves.
+    event(float sTime, int eType, float dur, particle *payload);
     void setColour(float red, float blue, float green);
-    void eventAnimate();
-    virtual ~event();
+
+    //what the fountain was launched with, for drawing it elsewhere
+    float getOriginX() const;
+    float getOriginZ() const;
+    void getColour(float &red, float &green, float &blue) const;
+    const particle *getLaunch() const;
+    size_t getLaunchCount() const;
+
+    //the box holding everything the event draws at time now, for
+    //culling; false if the event has no bounds and can't be culled
+    bool getBounds(float now, GLfloat *low, GLfloat *high) const;
 private:
     int currentX, currentZ;
-    void percussionFountain();
+    float r, g, b;
+    particle *launch;
+    size_t launchCount;
+    //the extremes of the launch velocities on each axis
+    GLfloat lowVelocity[3], highVelocity[3];
     void setupFountain();
-    void drawSpheres();
-    float myRandom();
 };
 
 #endif 
@@ -0,0 +1,99 @@
+
+#include "eventtimeline.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+bool startsBefore(const eventTimeline::eventSpec &a,
+                  const eventTimeline::eventSpec &b)
+{
+    return a.startTime < b.startTime;
+}
+
+bool eventStartsBefore(const event &e, float time)
+{
+    return e.startTime < time;
+}
+
+bool timeBeforeEvent(float time, const event &e)
+{
+    return time < e.startTime;
+}
+
+}
+
+eventTimeline::eventTimeline() :
+    current(new eventSet)
+{
+    current->longestDuration = 0;
+}
+
+void eventTimeline::publish(specList *specs)
+{
+    std::unique_ptr<specList> owned(specs);
+    std::shared_ptr<eventSet> set(new eventSet);
+
+    std::stable_sort(specs->begin(), specs->end(), startsBefore);
+
+    //the arena is sized up front and never grows, so the pointers the
+    //events keep into it stay good for as long as the set is around
+    size_t particles = 0;
+    for (size_t i = 0; i < specs->size(); ++i)
+    {
+        particles += event::payloadSize((*specs)[i].effectType);
+    }
+
+    set->payload.resize(particles);
+    set->events.reserve(specs->size());
+    set->longestDuration = 0;
+
+    size_t used = 0;
+    for (size_t i = 0; i < specs->size(); ++i)
+    {
+        const eventSpec &s = (*specs)[i];
+        set->events.push_back(event(s.startTime, s.effectType, s.duration,
+                                    set->payload.data() + used));
+        used += event::payloadSize(s.effectType);
+        set->longestDuration = std::max(set->longestDuration, s.duration);
+    }
+
+    std::atomic_store(&pending, set);
+}
+
+bool eventTimeline::update()
+{
+    std::shared_ptr<eventSet> set =
+            std::atomic_exchange(&pending, std::shared_ptr<eventSet>());
+    if (!set) return false;
+
+    current.swap(set);
+    return true;
+}
+
+const std::vector<event> &eventTimeline::getEvents() const
+{
+    return current->events;
+}
+
+const std::vector<event::particle> &eventTimeline::getPayload() const
+{
+    return current->payload;
+}
+
+void eventTimeline::activeRange(float now, size_t &first, size_t &last) const
+{
+    const std::vector<event> &events = current->events;
+
+    first = std::lower_bound(events.begin(), events.end(),
+                             now - current->longestDuration, eventStartsBefore)
+            - events.begin();
+    last = std::upper_bound(events.begin() + first, events.end(),
+                            now, timeBeforeEvent)
+            - events.begin();
+}
+
+eventTimeline::~eventTimeline()
+{
+}
@@ -0,0 +1,66 @@
+
+#ifndef EVENTTIMELINE_H
+#define EVENTTIMELINE_H
+
+#include "event.h"
+
+#include <memory>
+#include <vector>
+
+//The events the display draws. Analysis threads publish() a complete
+//new set at any time; the drawing thread calls update() once a frame,
+//which swaps in the newest set if there is one. Events hold no GL
+//state, so the whole set is built by publish() on the analysing
+//thread, and all update() does is swap a pointer.
+//
+//The events are kept by value in one array sorted by startTime, and
+//their particles in one more, the payload arena, sized for the whole
+//set before any event is built so the events can point into it. A set
+//of tens of thousands of onsets is two allocations, and finding the
+//ones playing at a given time is a binary search.
+class eventTimeline {
+public:
+    //what an event is built from
+    struct eventSpec {
+        float startTime;
+        int effectType;
+        float duration;
+    };
+    typedef std::vector<eventSpec> specList;
+
+    eventTimeline();
+    virtual ~eventTimeline();
+
+    //from any thread: build events from these and have them replace
+    //the current ones from the next update() on. Takes ownership of
+    //specs.
+    void publish(specList *specs);
+
+    //drawing thread: swap in the last published set, if any. Returns
+    //true if the events changed.
+    bool update();
+
+    //drawing thread: the current events, in startTime order, and the
+    //arena their particles are in
+    const std::vector<event> &getEvents() const;
+    const std::vector<event::particle> &getPayload() const;
+
+    //drawing thread: the events that may be playing at now are
+    //getEvents()[first, last); the caller still checks their endTime
+    void activeRange(float now, size_t &first, size_t &last) const;
+
+private:
+    eventTimeline(const eventTimeline &);
+    eventTimeline &operator=(const eventTimeline &);
+
+    struct eventSet {
+        std::vector<event> events;
+        std::vector<event::particle> payload;
+        float longestDuration;
+    };
+
+    std::shared_ptr<eventSet> pending;
+    std::shared_ptr<eventSet> current;
+};
+
+#endif /* EVENTTIMELINE_H */
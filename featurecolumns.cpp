@@ -0,0 +1,488 @@
+
+#include "featurecolumns.h"
+
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using Vamp::Plugin;
+
+static const char magic[4] = { 'V', 'R', 'C', 'C' };
+static const uint32_t version = 1;
+
+struct fileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t unit;
+    uint32_t outputCount;
+};
+
+//fixed part of an output block; offsets are from the start of the file
+struct columnHeader {
+    int32_t outputNo;
+    uint32_t sampleType;
+    uint32_t flags;
+    uint32_t binCount;
+    float minValue;
+    float maxValue;
+    float quantizeStep;
+    float sampleRate;
+    uint64_t rowCount;
+    uint64_t columnCount;
+    uint64_t labelCount;
+    uint64_t strings;
+    uint64_t times;
+    uint64_t durations;
+    uint64_t valueCounts;
+    uint64_t values;
+    uint64_t labelIndices;
+    uint64_t labelOffsets; //labelCount + 1 uint64 offsets into labelBytes
+    uint64_t labelBytes;
+};
+
+static_assert(sizeof (fileHeader) == 16, "fileHeader layout");
+static_assert(sizeof (columnHeader) == 120, "columnHeader layout");
+
+enum {
+    hasFixedBinCount = 1,
+    hasKnownExtents = 2,
+    isQuantized = 4,
+    hasDuration = 8
+};
+
+static size_t aligned(size_t n)
+{
+    return (n + 7) & ~size_t(7);
+}
+
+//everything is assembled in memory and written in one go
+
+static void append(std::vector<char> &out, const void *data, size_t n)
+{
+    const char *c = (const char *) data;
+    out.insert(out.end(), c, c + n);
+}
+
+static void pad(std::vector<char> &out)
+{
+    out.resize(aligned(out.size()), 0);
+}
+
+static void appendString(std::vector<char> &out, const std::string &s)
+{
+    uint32_t n = s.length();
+    append(out, &n, sizeof (n));
+    append(out, s.data(), n);
+}
+
+featureColumns::featureColumns(bool useFrames) :
+    useFrames(useFrames)
+{
+}
+
+void featureColumns::add(int outputNo, const Plugin::OutputDescriptor &output,
+                         int64_t time, int64_t duration,
+                         const Plugin::Feature &feature)
+{
+    std::map<int, outputColumns>::iterator i = outputs.find(outputNo);
+    if (i == outputs.end())
+    {
+        i = outputs.insert(std::make_pair(outputNo, outputColumns())).first;
+        i->second.descriptor = output;
+    }
+    outputColumns &c = i->second;
+
+    c.times.push_back(time);
+    c.durations.push_back(duration);
+    c.valueCounts.push_back(feature.values.size());
+    c.values.insert(c.values.end(), feature.values.begin(), feature.values.end());
+
+    if (feature.label == "")
+    {
+        c.labelIndices.push_back(-1);
+    }
+    else
+    {
+        std::map<std::string, int32_t>::iterator l = c.labelMap.find(feature.label);
+        if (l == c.labelMap.end())
+        {
+            l = c.labelMap.insert(std::make_pair(feature.label, int32_t(c.labels.size()))).first;
+            c.labels.push_back(feature.label);
+        }
+        c.labelIndices.push_back(l->second);
+    }
+}
+
+bool featureColumns::write(FILE *file) const
+{
+    std::vector<char> out;
+
+    fileHeader fh;
+    memcpy(fh.magic, magic, 4);
+    fh.version = version;
+    fh.unit = useFrames ? 1 : 0;
+    fh.outputCount = outputs.size();
+    append(out, &fh, sizeof (fh));
+
+    size_t directory = out.size();
+    out.resize(out.size() + outputs.size() * sizeof (uint64_t), 0);
+
+    int index = 0;
+    for (std::map<int, outputColumns>::const_iterator i = outputs.begin();
+            i != outputs.end(); ++i, ++index)
+    {
+        const outputColumns &c = i->second;
+        const Plugin::OutputDescriptor &d = c.descriptor;
+
+        pad(out);
+        uint64_t start = out.size();
+        memcpy(&out[directory + index * sizeof (uint64_t)], &start, sizeof (start));
+
+        size_t rows = c.times.size();
+        size_t columns = 0;
+        if (d.hasFixedBinCount)
+        {
+            columns = d.binCount;
+        }
+        for (size_t r = 0; r < rows; ++r)
+        {
+            if (c.valueCounts[r] > columns) columns = c.valueCounts[r];
+        }
+
+        columnHeader h;
+        memset(&h, 0, sizeof (h));
+        h.outputNo = i->first;
+        h.sampleType = d.sampleType;
+        h.flags = (d.hasFixedBinCount ? hasFixedBinCount : 0) |
+                (d.hasKnownExtents ? hasKnownExtents : 0) |
+                (d.isQuantized ? isQuantized : 0) |
+                (d.hasDuration ? hasDuration : 0);
+        h.binCount = d.binCount;
+        h.minValue = d.minValue;
+        h.maxValue = d.maxValue;
+        h.quantizeStep = d.quantizeStep;
+        h.sampleRate = d.sampleRate;
+        h.rowCount = rows;
+        h.columnCount = columns;
+        h.labelCount = c.labels.size();
+        out.resize(out.size() + sizeof (h), 0);
+
+        h.strings = out.size();
+        appendString(out, d.identifier);
+        appendString(out, d.name);
+        appendString(out, d.description);
+        appendString(out, d.unit);
+        uint32_t names = d.binNames.size();
+        append(out, &names, sizeof (names));
+        for (size_t n = 0; n < d.binNames.size(); ++n)
+        {
+            appendString(out, d.binNames[n]);
+        }
+
+        pad(out);
+        h.times = out.size();
+        if (rows) append(out, &c.times[0], rows * sizeof (int64_t));
+
+        pad(out);
+        h.durations = out.size();
+        if (rows) append(out, &c.durations[0], rows * sizeof (int64_t));
+
+        pad(out);
+        h.valueCounts = out.size();
+        if (rows) append(out, &c.valueCounts[0], rows * sizeof (uint32_t));
+
+        pad(out);
+        h.values = out.size();
+        std::vector<float> row(columns);
+        size_t from = 0;
+        for (size_t r = 0; r < rows; ++r)
+        {
+            uint32_t n = c.valueCounts[r];
+            for (size_t v = 0; v < columns; ++v)
+            {
+                row[v] = (v < n ? c.values[from + v] : std::numeric_limits<float>::quiet_NaN());
+            }
+            from += n;
+            if (columns) append(out, &row[0], columns * sizeof (float));
+        }
+
+        pad(out);
+        h.labelIndices = out.size();
+        if (rows) append(out, &c.labelIndices[0], rows * sizeof (int32_t));
+
+        pad(out);
+        h.labelOffsets = out.size();
+        uint64_t offset = 0;
+        for (size_t l = 0; l < c.labels.size(); ++l)
+        {
+            append(out, &offset, sizeof (offset));
+            offset += c.labels[l].length();
+        }
+        append(out, &offset, sizeof (offset));
+
+        h.labelBytes = out.size();
+        for (size_t l = 0; l < c.labels.size(); ++l)
+        {
+            append(out, c.labels[l].data(), c.labels[l].length());
+        }
+
+        memcpy(&out[start], &h, sizeof (h));
+    }
+
+    pad(out);
+    return fwrite(&out[0], 1, out.size(), file) == out.size();
+}
+
+struct columnReader::output {
+    columnHeader header;
+    Plugin::OutputDescriptor descriptor;
+};
+
+columnReader::columnReader() :
+    mapped(0),
+    length(0),
+    frames(false)
+{
+}
+
+bool columnReader::open(const std::string &filename)
+{
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof (fileHeader))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void *m = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (m == MAP_FAILED) return false;
+
+    mapped = (const char *) m;
+    length = st.st_size;
+
+    const fileHeader *fh = (const fileHeader *) mapped;
+    if (memcmp(fh->magic, magic, 4) != 0 || fh->version != version ||
+            sizeof (fileHeader) + uint64_t(fh->outputCount) * sizeof (uint64_t) > length)
+    {
+        close();
+        return false;
+    }
+    frames = (fh->unit == 1);
+
+    const uint64_t *directory = (const uint64_t *) (mapped + sizeof (fileHeader));
+    for (uint32_t i = 0; i < fh->outputCount; ++i)
+    {
+        output *o = new output;
+        outputs.push_back(o);
+        if (!readOutput(directory[i], *o))
+        {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+//whether rows * columns items of size bytes each, from offset on, lie
+//within length bytes and start aligned for their type. Everything here
+//comes from the file, so the sizes are compared by dividing what is
+//left rather than by multiplying out counts that could wrap.
+
+static bool fits(uint64_t offset, uint64_t rows, uint64_t columns,
+                 size_t size, uint64_t length)
+{
+    if (offset % size != 0 || offset > length) return false;
+    uint64_t items = (length - offset) / size;
+    return columns == 0 || rows <= items / columns;
+}
+
+bool columnReader::readOutput(uint64_t offset, output &o)
+{
+    if (offset % 8 != 0 || offset > length ||
+            length - offset < sizeof (columnHeader))
+    {
+        return false;
+    }
+    const columnHeader &h = *(const columnHeader *) (mapped + offset);
+    o.header = h;
+
+    //every column has to lie within the file before we hand it out
+    uint64_t rows = h.rowCount;
+    if (h.strings > length ||
+            !fits(h.times, rows, 1, sizeof (int64_t), length) ||
+            !fits(h.durations, rows, 1, sizeof (int64_t), length) ||
+            !fits(h.valueCounts, rows, 1, sizeof (uint32_t), length) ||
+            !fits(h.values, rows, h.columnCount, sizeof (float), length) ||
+            !fits(h.labelIndices, rows, 1, sizeof (int32_t), length) ||
+            h.labelCount >= length / sizeof (uint64_t) ||
+            !fits(h.labelOffsets, h.labelCount + 1, 1, sizeof (uint64_t), length) ||
+            h.labelBytes > length)
+    {
+        return false;
+    }
+
+    //and every label within the label bytes, so getLabel() needn't check
+    const uint64_t *labelOffsets = (const uint64_t *) (mapped + h.labelOffsets);
+    for (uint64_t i = 0; i < h.labelCount; ++i)
+    {
+        if (labelOffsets[i] > labelOffsets[i + 1]) return false;
+    }
+    if (labelOffsets[h.labelCount] > length - h.labelBytes) return false;
+
+    const char *p = mapped + h.strings;
+    const char *end = mapped + length;
+    std::string *strings[] = {
+        &o.descriptor.identifier, &o.descriptor.name,
+        &o.descriptor.description, &o.descriptor.unit
+    };
+    for (int i = 0; i < 5; ++i)
+    {
+        if (size_t(end - p) < sizeof (uint32_t)) return false;
+        uint32_t n;
+        memcpy(&n, p, sizeof (n));
+        p += sizeof (n);
+        if (i == 4)
+        {
+            //bin names: a count, then that many strings
+            for (uint32_t b = 0; b < n; ++b)
+            {
+                uint32_t len;
+                if (size_t(end - p) < sizeof (len)) return false;
+                memcpy(&len, p, sizeof (len));
+                p += sizeof (len);
+                if (len > size_t(end - p)) return false;
+                o.descriptor.binNames.push_back(std::string(p, len));
+                p += len;
+            }
+            break;
+        }
+        if (n > size_t(end - p)) return false;
+        strings[i]->assign(p, n);
+        p += n;
+    }
+
+    o.descriptor.hasFixedBinCount = (h.flags & hasFixedBinCount) != 0;
+    o.descriptor.binCount = h.binCount;
+    o.descriptor.hasKnownExtents = (h.flags & hasKnownExtents) != 0;
+    o.descriptor.minValue = h.minValue;
+    o.descriptor.maxValue = h.maxValue;
+    o.descriptor.isQuantized = (h.flags & isQuantized) != 0;
+    o.descriptor.quantizeStep = h.quantizeStep;
+    o.descriptor.sampleType = Plugin::OutputDescriptor::SampleType(h.sampleType);
+    o.descriptor.sampleRate = h.sampleRate;
+    o.descriptor.hasDuration = (h.flags & hasDuration) != 0;
+    return true;
+}
+
+void columnReader::close()
+{
+    for (size_t i = 0; i < outputs.size(); ++i)
+    {
+        delete outputs[i];
+    }
+    outputs.clear();
+
+    if (mapped)
+    {
+        munmap((void *) mapped, length);
+        mapped = 0;
+        length = 0;
+    }
+}
+
+bool columnReader::usesFrames() const
+{
+    return frames;
+}
+
+int columnReader::getOutputCount() const
+{
+    return outputs.size();
+}
+
+int columnReader::getOutputNumber(int index) const
+{
+    return outputs[index]->header.outputNo;
+}
+
+const Plugin::OutputDescriptor &columnReader::getDescriptor(int index) const
+{
+    return outputs[index]->descriptor;
+}
+
+size_t columnReader::getRowCount(int index) const
+{
+    return outputs[index]->header.rowCount;
+}
+
+size_t columnReader::getColumnCount(int index) const
+{
+    return outputs[index]->header.columnCount;
+}
+
+column<int64_t> columnReader::getTimes(int index) const
+{
+    const columnHeader &h = outputs[index]->header;
+    return column<int64_t>((const int64_t *) (mapped + h.times), h.rowCount);
+}
+
+column<int64_t> columnReader::getDurations(int index) const
+{
+    const columnHeader &h = outputs[index]->header;
+    return column<int64_t>((const int64_t *) (mapped + h.durations), h.rowCount);
+}
+
+column<uint32_t> columnReader::getValueCounts(int index) const
+{
+    const columnHeader &h = outputs[index]->header;
+    return column<uint32_t>((const uint32_t *) (mapped + h.valueCounts), h.rowCount);
+}
+
+column<float> columnReader::getValues(int index) const
+{
+    const columnHeader &h = outputs[index]->header;
+    return column<float>((const float *) (mapped + h.values), h.rowCount * h.columnCount);
+}
+
+column<float> columnReader::getRow(int index, size_t row) const
+{
+    const columnHeader &h = outputs[index]->header;
+    uint32_t n = getValueCounts(index)[row];
+    if (n > h.columnCount) n = h.columnCount;
+    return column<float>((const float *) (mapped + h.values) + row * h.columnCount, n);
+}
+
+column<int32_t> columnReader::getLabelIndices(int index) const
+{
+    const columnHeader &h = outputs[index]->header;
+    return column<int32_t>((const int32_t *) (mapped + h.labelIndices), h.rowCount);
+}
+
+size_t columnReader::getLabelCount(int index) const
+{
+    return outputs[index]->header.labelCount;
+}
+
+column<char> columnReader::getLabel(int index, int32_t label) const
+{
+    const columnHeader &h = outputs[index]->header;
+    if (label < 0 || uint64_t(label) >= h.labelCount) return column<char>();
+    const uint64_t *offsets = (const uint64_t *) (mapped + h.labelOffsets);
+    return column<char>(mapped + h.labelBytes + offsets[label],
+                        offsets[label + 1] - offsets[label]);
+}
+
+columnReader::~columnReader()
+{
+    close();
+}
@@ -0,0 +1,116 @@
+
+#ifndef FEATURECOLUMNS_H
+#define FEATURECOLUMNS_H
+
+#include <vamp-hostsdk/Plugin.h>
+
+#include <cstdio>
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+//Columnar feature files. A file holds the features of one or more
+//plugin outputs; for each output there is a header carrying its
+//OutputDescriptor, then the columns:
+//  times        int64 per feature (ns, or frames if usesFrames())
+//  durations    int64 per feature, -1 where there is none
+//  value counts uint32 per feature
+//  values       float matrix, one row per feature and getColumnCount()
+//               columns (binCount for fixed-size outputs), short rows
+//               padded with NaN
+//  labels       int32 per feature into the output's label table, -1 for
+//               no label; each distinct label is stored once
+//
+//Layout, all native byte order and every section 8-byte aligned:
+//  "VRCC", uint32 version, uint32 unit (0 ns, 1 frames), uint32 outputs
+//  uint64 offset of each output block
+//  output block: a columnHeader, then the sections it points to
+//
+//featureColumns collects features and writes a file; columnReader maps
+//one and hands out the columns in place.
+
+//a read-only view of part of a mapped file
+template <typename T>
+struct column {
+    const T *data;
+    size_t size;
+
+    column() : data(0), size(0) { }
+    column(const T *d, size_t n) : data(d), size(n) { }
+
+    const T &operator[](size_t i) const { return data[i]; }
+    const T *begin() const { return data; }
+    const T *end() const { return data + size; }
+    bool empty() const { return size == 0; }
+};
+
+class featureColumns {
+public:
+    featureColumns(bool useFrames);
+
+    //time and duration are in ns or frames as given to the constructor;
+    //duration is -1 if the feature has none
+    void add(int outputNo, const Vamp::Plugin::OutputDescriptor &output,
+             int64_t time, int64_t duration,
+             const Vamp::Plugin::Feature &feature);
+
+    bool write(FILE *file) const;
+
+private:
+    struct outputColumns {
+        Vamp::Plugin::OutputDescriptor descriptor;
+        std::vector<int64_t> times;
+        std::vector<int64_t> durations;
+        std::vector<uint32_t> valueCounts;
+        std::vector<float> values; //unpadded, rows end to end
+        std::vector<int32_t> labelIndices;
+        std::vector<std::string> labels;
+        std::map<std::string, int32_t> labelMap;
+    };
+
+    bool useFrames;
+    std::map<int, outputColumns> outputs;
+};
+
+class columnReader {
+public:
+    columnReader();
+    virtual ~columnReader();
+
+    bool open(const std::string &filename);
+    void close();
+
+    bool usesFrames() const;
+
+    //outputs are indexed 0..getOutputCount()-1, in plugin output order
+    int getOutputCount() const;
+    int getOutputNumber(int index) const;
+    const Vamp::Plugin::OutputDescriptor &getDescriptor(int index) const;
+
+    size_t getRowCount(int index) const;
+    size_t getColumnCount(int index) const;
+
+    column<int64_t> getTimes(int index) const;
+    column<int64_t> getDurations(int index) const;
+    column<uint32_t> getValueCounts(int index) const;
+    column<float> getValues(int index) const; //the whole matrix
+    column<float> getRow(int index, size_t row) const; //without padding
+    column<int32_t> getLabelIndices(int index) const;
+    size_t getLabelCount(int index) const;
+    column<char> getLabel(int index, int32_t label) const;
+
+private:
+    columnReader(const columnReader &);
+    columnReader &operator=(const columnReader &);
+
+    struct output;
+    bool readOutput(uint64_t offset, output &o);
+
+    const char *mapped;
+    size_t length;
+    bool frames;
+    std::vector<output *> outputs;
+};
+
+#endif /* FEATURECOLUMNS_H */
@@ -0,0 +1,285 @@
+
+#include "featurewriter.h"
+
+#include <cstring>
+#include <stdint.h>
+
+using Vamp::Plugin;
+using Vamp::RealTime;
+
+featureWriter::featureWriter(format fmt, size_t bufferSize) :
+    fmt(fmt),
+    useFrames(false),
+    outputNo(0),
+    columns(0),
+    file(0),
+    failed(false),
+    capacity(bufferSize < 256 ? 256 : bufferSize),
+    used(0)
+{
+    buffer = new char[capacity];
+}
+
+featureWriter::format featureWriter::formatForFile(const std::string &filename)
+{
+    size_t dot = filename.rfind('.');
+    if (dot == std::string::npos) return textFormat;
+    std::string ext = filename.substr(dot + 1);
+    if (ext == "csv") return csvFormat;
+    if (ext == "bin") return binaryFormat;
+    if (ext == "cols") return columnFormat;
+    return textFormat;
+}
+
+bool featureWriter::open(const std::string &filename, bool frames)
+{
+    close();
+
+    useFrames = frames;
+    failed = false;
+
+    if (filename == "")
+    {
+        file = stdout;
+    }
+    else
+    {
+        bool binary = (fmt == binaryFormat || fmt == columnFormat);
+        file = fopen(filename.c_str(), binary ? "wb" : "w");
+        if (!file) return false;
+    }
+
+    if (fmt == columnFormat)
+    {
+        columns = new featureColumns(useFrames);
+    }
+
+    if (fmt == binaryFormat)
+    {
+        uint32_t header[2] = { 1, useFrames ? 1u : 0u };
+        put("VRCF", 4);
+        put((const char *) header, sizeof (header));
+    }
+    return true;
+}
+
+bool featureWriter::isOpen() const
+{
+    return file != 0;
+}
+
+void featureWriter::setOutput(int n, const Plugin::OutputDescriptor &descriptor)
+{
+    outputNo = n;
+    output = descriptor;
+}
+
+void featureWriter::flush()
+{
+    if (used > 0 && file)
+    {
+        if (fwrite(buffer, 1, used, file) != used) failed = true;
+    }
+    used = 0;
+}
+
+void featureWriter::reserve(size_t n)
+{
+    if (used + n > capacity) flush();
+}
+
+void featureWriter::put(char c)
+{
+    reserve(1);
+    buffer[used++] = c;
+}
+
+void featureWriter::put(const char *s, size_t n)
+{
+    if (n > capacity)
+    {
+        flush();
+        if (file && fwrite(s, 1, n, file) != n) failed = true;
+        return;
+    }
+    reserve(n);
+    memcpy(buffer + used, s, n);
+    used += n;
+}
+
+void featureWriter::putInteger(long long n)
+{
+    char digits[24];
+    int count = 0;
+    unsigned long long u = (n < 0 ? 0ull - (unsigned long long) n : n);
+    do
+    {
+        digits[count++] = char('0' + u % 10);
+        u /= 10;
+    }
+    while (u > 0);
+
+    reserve(count + 1);
+    if (n < 0) buffer[used++] = '-';
+    while (count > 0) buffer[used++] = digits[--count];
+}
+
+void featureWriter::putTime(const RealTime &time)
+{
+    reserve(32);
+    int n = time.toString(buffer + used, 32);
+    if (fmt == csvFormat && n > 0 && buffer[used] == ' ')
+    {
+        //toString pads positive times with a space for the sign
+        memmove(buffer + used, buffer + used + 1, n - 1);
+        --n;
+    }
+    used += n;
+}
+
+void featureWriter::putValues(const Plugin::Feature &feature)
+{
+    const char separator = (fmt == csvFormat ? ',' : ' ');
+
+    for (size_t i = 0; i < feature.values.size(); ++i)
+    {
+        //%g is what an ostream gives a float by default
+        reserve(32);
+        buffer[used++] = separator;
+        int n = snprintf(buffer + used, 31, "%g", double(feature.values[i]));
+        if (n > 30) n = 30;
+        if (n > 0) used += n;
+    }
+
+    put(separator);
+
+    const std::string &label = feature.label;
+    if (fmt == csvFormat && label.find_first_of(",\"\n") != std::string::npos)
+    {
+        put('"');
+        for (size_t i = 0; i < label.length(); ++i)
+        {
+            if (label[i] == '"') put('"');
+            put(label[i]);
+        }
+        put('"');
+    }
+    else
+    {
+        put(label.c_str(), label.length());
+    }
+
+    put('\n');
+}
+
+void featureWriter::putBinary(long long time, long long duration,
+                              const Plugin::Feature &feature)
+{
+    int64_t times[2] = { time, duration };
+    uint32_t counts[2] = {
+        uint32_t(feature.values.size()), uint32_t(feature.label.length())
+    };
+    put((const char *) times, sizeof (times));
+    put((const char *) counts, sizeof (counts));
+    if (!feature.values.empty())
+    {
+        put((const char *) &feature.values[0],
+            feature.values.size() * sizeof (float));
+    }
+    put(feature.label.c_str(), feature.label.length());
+}
+
+void featureWriter::write(const RealTime &time, const Plugin::Feature &feature)
+{
+    if (fmt == binaryFormat || fmt == columnFormat)
+    {
+        long long duration = -1;
+        if (feature.hasDuration)
+        {
+            duration = feature.duration.sec * 1000000000ll + feature.duration.nsec;
+        }
+        long long ns = time.sec * 1000000000ll + time.nsec;
+        if (fmt == columnFormat)
+        {
+            columns->add(outputNo, output, ns, duration, feature);
+        }
+        else
+        {
+            putBinary(ns, duration, feature);
+        }
+        return;
+    }
+
+    putTime(time);
+    if (feature.hasDuration)
+    {
+        put(',');
+        putTime(feature.duration);
+    }
+    else if (fmt == csvFormat)
+    {
+        //keep the columns lined up
+        put(',');
+    }
+    if (fmt == textFormat) put(':');
+    putValues(feature);
+}
+
+void featureWriter::write(long frame, long durationFrames,
+                          const Plugin::Feature &feature)
+{
+    if (fmt == binaryFormat)
+    {
+        putBinary(frame, feature.hasDuration ? durationFrames : -1, feature);
+        return;
+    }
+    if (fmt == columnFormat)
+    {
+        columns->add(outputNo, output, frame,
+                     feature.hasDuration ? durationFrames : -1, feature);
+        return;
+    }
+
+    putInteger(frame);
+    if (feature.hasDuration)
+    {
+        put(',');
+        putInteger(durationFrames);
+    }
+    else if (fmt == csvFormat)
+    {
+        put(',');
+    }
+    if (fmt == textFormat) put(':');
+    putValues(feature);
+}
+
+bool featureWriter::close()
+{
+    if (!file) return true;
+
+    if (columns)
+    {
+        if (!columns->write(file)) failed = true;
+        delete columns;
+        columns = 0;
+    }
+
+    flush();
+    if (file == stdout)
+    {
+        if (fflush(file) != 0) failed = true;
+    }
+    else if (fclose(file) != 0)
+    {
+        failed = true;
+    }
+    file = 0;
+    return !failed;
+}
+
+featureWriter::~featureWriter()
+{
+    close();
+    delete[] buffer;
+}
@@ -0,0 +1,79 @@
+
+#ifndef FEATUREWRITER_H
+#define FEATUREWRITER_H
+
+#include <vamp-hostsdk/Plugin.h>
+#include <vamp-hostsdk/RealTime.h>
+
+#include "featurecolumns.h"
+
+#include <cstdio>
+#include <string>
+
+//Writes plugin features to a file (or stdout) through one large
+//buffer that only goes out when it fills or on close(). Numbers are
+//formatted straight into the buffer, without iostreams.
+//
+//textFormat is the format printFeatures has always written:
+//  <time>[,<duration>]: <value> <value>... <label>
+//csvFormat is the same fields comma-separated, with the duration
+//column left empty when there is none and the label last.
+//binaryFormat is "VRCF", a uint32 version (1) and a uint32 unit (0 for
+//nanoseconds, 1 for frames), then per feature: int64 time, int64
+//duration (-1 if none), uint32 value count, uint32 label length, the
+//values as floats and the label bytes, all in native byte order.
+//columnFormat collects everything and writes a columnar file (see
+//featurecolumns.h) on close().
+class featureWriter {
+public:
+    enum format {
+        textFormat, csvFormat, binaryFormat, columnFormat
+    };
+
+    featureWriter(format fmt = textFormat, size_t bufferSize = 1 << 20);
+    virtual ~featureWriter();
+
+    //picks csvFormat for .csv, binaryFormat for .bin, columnFormat for
+    //.cols, else textFormat
+    static format formatForFile(const std::string &filename);
+
+    //an empty filename writes to stdout
+    bool open(const std::string &filename, bool useFrames);
+    bool isOpen() const;
+
+    //the output the following features belong to; needed for columnFormat
+    void setOutput(int outputNo, const Vamp::Plugin::OutputDescriptor &output);
+
+    void write(const Vamp::RealTime &time, const Vamp::Plugin::Feature &feature);
+    void write(long frame, long durationFrames, const Vamp::Plugin::Feature &feature);
+
+    //flush and close; false if anything failed to write
+    bool close();
+
+private:
+    featureWriter(const featureWriter &);
+    featureWriter &operator=(const featureWriter &);
+
+    void flush();
+    void reserve(size_t n);
+    void put(char c);
+    void put(const char *s, size_t n);
+    void putInteger(long long n);
+    void putTime(const Vamp::RealTime &time);
+    void putValues(const Vamp::Plugin::Feature &feature);
+    void putBinary(long long time, long long duration,
+                   const Vamp::Plugin::Feature &feature);
+
+    format fmt;
+    bool useFrames;
+    int outputNo;
+    Vamp::Plugin::OutputDescriptor output;
+    featureColumns *columns;
+    FILE *file;
+    bool failed;
+    char *buffer;
+    size_t capacity;
+    size_t used;
+};
+
+#endif /* FEATUREWRITER_H */
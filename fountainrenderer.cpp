@@ -0,0 +1,230 @@
+
+//for the shader and buffer object entry points
+#define GL_GLEXT_PROTOTYPES
+
+#include "fountainrenderer.h"
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+
+static const char *vertexSource =
+        "#version 120\n"
+        "attribute vec3 velocity;\n"
+        "uniform vec3 origin;\n"
+        "uniform float steps;\n"
+        "uniform float gravity;\n"
+        "void main()\n"
+        "{\n"
+        "    vec3 p = origin + velocity * steps;\n"
+        "    p.y -= gravity * steps * (steps - 1.0) * 0.5;\n"
+        "    gl_Position = gl_ModelViewProjectionMatrix * vec4(p, 1.0);\n"
+        "    gl_FrontColor = gl_Color;\n"
+        "}\n";
+
+static const char *fragmentSource =
+        "#version 120\n"
+        "void main()\n"
+        "{\n"
+        "    gl_FragColor = gl_Color;\n"
+        "}\n";
+
+//compiles one shader, returning 0 and reporting why if it fails
+
+static GLuint compileShader(GLenum type, const char *source)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, 0);
+    glCompileShader(shader);
+
+    GLint ok = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok)
+    {
+        char log[1024] = "";
+        glGetShaderInfoLog(shader, sizeof (log), 0, log);
+        std::cerr << "fountainRenderer: shader failed to compile: " << log << std::endl;
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+fountainRenderer::fountainRenderer() :
+    program(0),
+    buffer(0),
+    velocityAttribute(-1),
+    originUniform(-1),
+    stepsUniform(-1),
+    gravityUniform(-1)
+{
+}
+
+bool fountainRenderer::create()
+{
+    destroy();
+
+    //shaders arrived in OpenGL 2.0
+    const char *version = (const char *) glGetString(GL_VERSION);
+    if (!version || version[0] < '2') return false;
+
+    GLuint vertex = compileShader(GL_VERTEX_SHADER, vertexSource);
+    GLuint fragment = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+    if (!vertex || !fragment)
+    {
+        if (vertex) glDeleteShader(vertex);
+        if (fragment) glDeleteShader(fragment);
+        return false;
+    }
+
+    program = glCreateProgram();
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    glLinkProgram(program);
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+
+    GLint ok = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok)
+    {
+        std::cerr << "fountainRenderer: shader program failed to link" << std::endl;
+        destroy();
+        return false;
+    }
+
+    velocityAttribute = glGetAttribLocation(program, "velocity");
+    originUniform = glGetUniformLocation(program, "origin");
+    stepsUniform = glGetUniformLocation(program, "steps");
+    gravityUniform = glGetUniformLocation(program, "gravity");
+
+    glGenBuffers(1, &buffer);
+    return true;
+}
+
+bool fountainRenderer::isReady() const
+{
+    return program != 0;
+}
+
+//the arena goes into the buffer as it is, and the shader reads each
+//particle's velocity out of it with a stride, so nothing is copied or
+//rearranged here on the drawing thread
+
+void fountainRenderer::setEvents(const std::vector<event> &events,
+                                 const std::vector<event::particle> &payload)
+{
+    fountains.clear();
+    if (!isReady()) return;
+
+    fountains.resize(events.size());
+
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        const event &e = events[i];
+        fountain &f = fountains[i];
+
+        f.first = GLint(e.getLaunch() - payload.data());
+        f.count = (e.effectType == 1 ? GLsizei(e.getLaunchCount()) : 0);
+        f.originX = e.getOriginX();
+        f.originZ = e.getOriginZ();
+        e.getColour(f.r, f.g, f.b);
+        f.startTime = e.startTime;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, payload.size() * sizeof (event::particle),
+                 payload.empty() ? 0 : payload.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+size_t fountainRenderer::particlesAt(size_t count, float detail)
+{
+    if (detail >= 1) return count;
+    size_t n = size_t(std::ceil(count * detail));
+    return n < count ? n : count;
+}
+
+void fountainRenderer::drawBatch(const std::vector<event> &events,
+                                 const std::vector<effectTable::item> &batch,
+                                 float now, void *renderer)
+{
+    static_cast<const fountainRenderer *>(renderer)->draw(events, batch, now);
+}
+
+void fountainRenderer::draw(const std::vector<event> &events,
+                            const std::vector<effectTable::item> &batch,
+                            float now) const
+{
+    if (!isReady())
+    {
+        drawOnCPU(events, batch, now);
+        return;
+    }
+
+    glUseProgram(program);
+    glUniform1f(gravityUniform, event::gravity);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glEnableVertexAttribArray(velocityAttribute);
+    glVertexAttribPointer(velocityAttribute, 3, GL_FLOAT, GL_FALSE,
+                          sizeof (event::particle),
+                          (const GLvoid *) offsetof(event::particle, xaccel));
+
+    for (size_t i = 0; i < batch.size(); ++i)
+    {
+        if (batch[i].index >= fountains.size()) continue;
+        const fountain &f = fountains[batch[i].index];
+        if (f.count == 0) continue;
+
+        glUniform3f(originUniform, f.originX, 0.0, f.originZ);
+        glUniform1f(stepsUniform, event::stepsSince(f.startTime, now));
+        glColor3f(f.r, f.g, f.b);
+        glDrawArrays(GL_POINTS, f.first,
+                     GLsizei(particlesAt(f.count, batch[i].detail)));
+    }
+
+    glDisableVertexAttribArray(velocityAttribute);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glUseProgram(0);
+}
+
+void fountainRenderer::drawOnCPU(const std::vector<event> &events,
+                                 const std::vector<effectTable::item> &batch,
+                                 float now) const
+{
+    GLfloat xyz[3];
+
+    //glPointSize(3);
+    glBegin(GL_POINTS);
+    for (size_t i = 0; i < batch.size(); ++i)
+    {
+        const event &e = events[batch[i].index];
+        const event::particle *launch = e.getLaunch();
+        float steps = event::stepsSince(e.startTime, now);
+        size_t count = particlesAt(e.getLaunchCount(), batch[i].detail);
+        GLfloat r, g, b;
+
+        e.getColour(r, g, b);
+        glColor3f(r, g, b);
+        for (size_t j = 0; j < count; ++j)
+        {
+            event::fountainPosition(launch[j], steps, xyz);
+            glVertex3fv(xyz);
+        }
+    }
+    glEnd();
+}
+
+void fountainRenderer::destroy()
+{
+    if (program) glDeleteProgram(program);
+    if (buffer) glDeleteBuffers(1, &buffer);
+    program = 0;
+    buffer = 0;
+    fountains.clear();
+}
+
+fountainRenderer::~fountainRenderer()
+{
+    //the GL context may be gone by now, so the objects are left to it
+}
@@ -0,0 +1,78 @@
+
+#ifndef FOUNTAINRENDERER_H
+#define FOUNTAINRENDERER_H
+
+#include "effecttable.h"
+
+#include <vector>
+
+//Draws fountain events on the GPU. The launch velocities of all the
+//fountains go into a vertex buffer once, when the events are set; after that a
+//vertex shader places every particle from its launch velocity and the
+//steps since the event started, as event::fountainPosition does:
+//
+//    p(n) = p0 + v n - gravity n (n - 1) / 2 in y
+//
+//Drawing a fountain is a few uniforms and one glDrawArrays, whatever
+//the number of particles, and the program and buffer are bound once for
+//all the fountains in a frame. Needs GLSL 1.20, which Mesa's llvmpipe
+//has; where it isn't available create() fails and draw() places the
+//particles on the CPU instead, still in one glBegin for the lot.
+class fountainRenderer {
+public:
+    fountainRenderer();
+    virtual ~fountainRenderer();
+
+    //needs a current GL context; returns false if the shaders can't
+    //be built
+    bool create();
+    bool isReady() const;
+
+    //drawing thread: replace the fountains with those among events,
+    //which draw() is then given; payload is the arena their particles
+    //are in (see eventTimeline)
+    void setEvents(const std::vector<event> &events,
+                   const std::vector<event::particle> &payload);
+
+    //draw the fountains in batch as they are at time now, each with
+    //the first detail of its particles (which are in random order, so
+    //any run of them is a fair sample); an effectTable::drawFunction,
+    //with the renderer as its context
+    static void drawBatch(const std::vector<event> &events,
+                          const std::vector<effectTable::item> &batch,
+                          float now, void *renderer);
+    void draw(const std::vector<event> &events,
+              const std::vector<effectTable::item> &batch, float now) const;
+
+    //deletes the GL objects; needs the context to still be current
+    void destroy();
+
+private:
+    fountainRenderer(const fountainRenderer &);
+    fountainRenderer &operator=(const fountainRenderer &);
+
+    void drawOnCPU(const std::vector<event> &events,
+                   const std::vector<effectTable::item> &batch,
+                   float now) const;
+
+    //how many of count particles to draw at detail
+    static size_t particlesAt(size_t count, float detail);
+
+    struct fountain {
+        GLint first;
+        GLsizei count;
+        GLfloat originX, originZ;
+        GLfloat r, g, b;
+        float startTime;
+    };
+
+    std::vector<fountain> fountains; //one per event, count 0 if not a fountain
+    GLuint program;
+    GLuint buffer;
+    GLint velocityAttribute;
+    GLint originUniform;
+    GLint stepsUniform;
+    GLint gravityUniform;
+};
+
+#endif /* FOUNTAINRENDERER_H */
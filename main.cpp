@@ -1,7 +1,7 @@
 
 
 #include <vamp-hostsdk/PluginHostAdapter.h>
-#include <vamp-hostsdk/PluginInputDomainAdapter.h>
+#include <vamp-hostsdk/PluginAdapterChain.h>
 #include <vamp-hostsdk/PluginLoader.h>
 
 #include <iostream>
@@ -14,10 +14,27 @@
 #include <chrono>
 #include <cstring>
 #include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <dirent.h>
+#include <sys/stat.h>
 
 #include "system.h"
 #include "event.h"
+#include "eventtimeline.h"
 #include "timer.h"
+#include "pluginpool.h"
+#include "taskpool.h"
+#include "featurewriter.h"
+#include "mappedwav.h"
+#include "decodestage.h"
+#include "decimator.h"
+#include "stagegeometry.h"
+#include "fountainrenderer.h"
+#include "effecttable.h"
+#include "viewfrustum.h"
 
 
 #define DEG_TO_RAD 0.017453293
@@ -28,8 +45,8 @@ using Vamp::Plugin;
 using Vamp::PluginHostAdapter;
 using Vamp::RealTime;
 using Vamp::HostExt::PluginLoader;
-using Vamp::HostExt::PluginWrapper;
-using Vamp::HostExt::PluginInputDomainAdapter;
+using Vamp::HostExt::InputAdapterChain;
+using Vamp::HostExt::PluginStaticData;
 
 
 //function declarations for glut
@@ -40,7 +57,10 @@ void animate(void);
 void initializeGraphics(void);
 void menu(int i);
 void calculate_lookpoint(void);
-void createEvents();
+eventTimeline::specList *createEvents();
+void drawSpheres(const std::vector<event> &events,
+                 const std::vector<effectTable::item> &batch, float,
+                 void *);
 void audio_callback(void *userdata, Uint8 *stream, int len);
 
 enum Verbosity
@@ -59,8 +79,15 @@ GLfloat centerx, centery, centerz;
 GLfloat eyex, eyey, eyez;
 GLfloat upx, upy, upz;
 
-//vector for holding events
-std::vector<event*> eventVector;
+//the events being drawn, which the analysis can replace while the show
+//is running
+eventTimeline timeline;
+//the ground and sky dome, held on the GPU
+stageGeometry stage;
+//draws the fountains on the GPU, if it can
+fountainRenderer fountains;
+//how each effect type is drawn
+effectTable effects;
 timer t;
 static Uint32 wavl;
 static Uint32 audiol;
@@ -68,6 +95,14 @@ static Uint8 *wavbuffer;
 static Uint8 *audio_pos;
 static SDL_AudioSpec wav_spec;
 bool SDLSetup;
+//progress and plugin details on stderr; off in batch mode, where
+//several files are analysed at once
+static bool verbose = true;
+//set when the show is quitting: analyses still running give up at the
+//next block, returning failure
+static std::atomic<bool> stopAnalysis(false);
+//the full-resolution analysis behind the show
+static std::thread refine;
 //example function to be delted later
 
 string header(string text, int level)
@@ -92,12 +127,14 @@ static double toSeconds(const RealTime &time)
 //example function to modifiy it is called when runPlugin is finished
 //needs to be modified to store results in a data structure
 
+//featureCount tracks the last index written for a fixed-rate output;
+//it belongs to the run so concurrent runs don't share it
+
 int printFeatures(int frame, int sr,
                   const Plugin::OutputDescriptor &output, int outputNo,
-                  const Plugin::FeatureSet &features, ofstream *out, bool useFrames)
+                  const Plugin::FeatureSet &features, featureWriter &out, bool useFrames,
+                  int &featureCount)
 {
-    static int featureCount = -1;
-
     if (features.find(outputNo) == features.end()) return 0;
 
     for (size_t i = 0; i < features.at(outputNo).size(); ++i)
@@ -128,22 +165,20 @@ int printFeatures(int frame, int sr,
         if (useFrames)
         {
 
-            int displayFrame = frame;
+            long displayFrame = frame;
 
             if (haveRt)
             {
                 displayFrame = RealTime::realTime2Frame(rt, sr);
             }
 
-            (out ? *out : cout) << displayFrame;
-
+            long durationFrames = 0;
             if (f.hasDuration)
             {
-                displayFrame = RealTime::realTime2Frame(f.duration, sr);
-                (out ? *out : cout) << "," << displayFrame;
+                durationFrames = RealTime::realTime2Frame(f.duration, sr);
             }
 
-            (out ? *out : cout) << ":";
+            out.write(displayFrame, durationFrames, f);
 
         }
         else
@@ -154,25 +189,10 @@ int printFeatures(int frame, int sr,
                 rt = RealTime::frame2RealTime(frame, sr);
             }
 
-            (out ? *out : cout) << rt.toString();
-
-            if (f.hasDuration)
-            {
-                rt = f.duration;
-                (out ? *out : cout) << "," << rt.toString();
-            }
-
-            (out ? *out : cout) << ":";
-        }
-
-        for (unsigned int j = 0; j < f.values.size(); ++j)
-        {
-            (out ? *out : cout) << " " << f.values[j];
+            out.write(rt, f);
         }
-        (out ? *out : cout) << " " << f.label;
-
-        (out ? *out : cout) << endl;
     }
+    return 0;
 }
 
 //example function to be deleted later
@@ -223,15 +243,17 @@ void enumeratePlugins(Verbosity verbosity)
             }
         }
 
-        Plugin *plugin = loader->loadPlugin(key, 48000);
-        if (plugin)
+        // Static data comes from the loader's plugin index, so listing
+        // does not need to load (or even open) any plugin library
+        PluginStaticData plugin = loader->getPluginStaticData(key);
+        if (plugin.pluginKey != "")
         {
 
             char c = char('A' + index);
             if (c > 'Z') c = char('a' + (index - 26));
 
-            PluginLoader::PluginCategoryHierarchy category =
-                    loader->getPluginCategory(key);
+            const PluginLoader::PluginCategoryHierarchy &category =
+                    plugin.category;
             string catstr;
             if (!category.empty())
             {
@@ -246,49 +268,49 @@ void enumeratePlugins(Verbosity verbosity)
             {
 
                 cout << "    [" << c << "] [v"
-                        << plugin->getVampApiVersion() << "] "
-                        << plugin->getName() << ", \""
-                        << plugin->getIdentifier() << "\"" << " ["
-                        << plugin->getMaker() << "]" << endl;
+                        << plugin.apiVersion << "] "
+                        << plugin.name << ", \""
+                        << plugin.identifier << "\"" << " ["
+                        << plugin.maker << "]" << endl;
 
                 if (catstr != "")
                 {
                     cout << "       > " << catstr << endl;
                 }
 
-                if (plugin->getDescription() != "")
+                if (plugin.description != "")
                 {
-                    cout << "        - " << plugin->getDescription() << endl;
+                    cout << "        - " << plugin.description << endl;
                 }
 
             }
             else if (verbosity == PluginInformationDetailed)
             {
 
-                cout << header(plugin->getName(), 2);
+                cout << header(plugin.name, 2);
                 cout << " - Identifier:         "
                         << key << endl;
                 cout << " - Plugin Version:     "
-                        << plugin->getPluginVersion() << endl;
+                        << plugin.pluginVersion << endl;
                 cout << " - Vamp API Version:   "
-                        << plugin->getVampApiVersion() << endl;
+                        << plugin.apiVersion << endl;
                 cout << " - Maker:              \""
-                        << plugin->getMaker() << "\"" << endl;
+                        << plugin.maker << "\"" << endl;
                 cout << " - Copyright:          \""
-                        << plugin->getCopyright() << "\"" << endl;
+                        << plugin.copyright << "\"" << endl;
                 cout << " - Description:        \""
-                        << plugin->getDescription() << "\"" << endl;
+                        << plugin.description << "\"" << endl;
                 cout << " - Input Domain:       "
-                        << (plugin->getInputDomain() == Vamp::Plugin::TimeDomain ?
+                        << (plugin.inputDomain == Vamp::Plugin::TimeDomain ?
                         "Time Domain" : "Frequency Domain") << endl;
                 cout << " - Default Step Size:  "
-                        << plugin->getPreferredStepSize() << endl;
+                        << plugin.preferredStepSize << endl;
                 cout << " - Default Block Size: "
-                        << plugin->getPreferredBlockSize() << endl;
+                        << plugin.preferredBlockSize << endl;
                 cout << " - Minimum Channels:   "
-                        << plugin->getMinChannelCount() << endl;
+                        << plugin.minChannelCount << endl;
                 cout << " - Maximum Channels:   "
-                        << plugin->getMaxChannelCount() << endl;
+                        << plugin.maxChannelCount << endl;
 
             }
             else if (verbosity == PluginIds)
@@ -296,13 +318,12 @@ void enumeratePlugins(Verbosity verbosity)
                 cout << "vamp:" << key << endl;
             }
 
-            Plugin::OutputList outputs =
-                    plugin->getOutputDescriptors();
+            Plugin::OutputList &outputs = plugin.outputs;
 
             if (verbosity == PluginInformationDetailed)
             {
 
-                Plugin::ParameterList params = plugin->getParameterDescriptors();
+                Plugin::ParameterList &params = plugin.parameters;
                 for (size_t j = 0; j < params.size(); ++j)
                 {
                     Plugin::ParameterDescriptor & pd(params[j]);
@@ -426,8 +447,6 @@ void enumeratePlugins(Verbosity verbosity)
             }
 
             ++index;
-
-            delete plugin;
         }
     }
 
@@ -438,107 +457,123 @@ void enumeratePlugins(Verbosity verbosity)
     }
 }
 
-int runPluginPercussionOnset(string programName,
-                             string output, int outputNo, string wavname,
-                             string outfilename, bool useFrames)
+//Runs the plugin with the given key over wavname, writing the features
+//of output outputNo to outfilename. The instance comes from the
+//pluginPool, so running the same plugin again on a file of the same
+//format reuses it rather than loading and initialising another.
+//
+//A decimation above 1 feeds the plugin a low-passed stream at the
+//file's rate divided by decimation (see decimator.h), for plugins that
+//don't need the full band. Feature times still come out on the file's
+//own timeline.
+int runPlugin(string programName, PluginLoader::PluginKey key,
+              const parameterMap &parameters, int outputNo,
+              string wavname, string outfilename, bool useFrames,
+              int decimation)
 {
-    PluginLoader *loader = PluginLoader::getInstance();
-
-    PluginLoader::PluginKey key = loader->composePluginKey("Vamp-example-plugins", "percussiononsets");
-
-    SNDFILE *sndfile;
+    mappedWav wav;
+    SNDFILE *sndfile = 0;
     SF_INFO sfinfo;
     memset(&sfinfo, 0, sizeof (SF_INFO));
 
-    sndfile = sf_open(wavname.c_str(), SFM_READ, &sfinfo);
-    if (!sndfile)
+    //uncompressed WAV is converted straight out of a mapping of the file;
+    //everything else goes through libsndfile
+    if (wav.open(wavname))
     {
-        cerr << programName << ": ERROR: Failed to open input file \""
-                << wavname << "\": " << sf_strerror(sndfile) << endl;
-        return 1;
+        sfinfo.samplerate = wav.getSampleRate();
+        sfinfo.channels = wav.getChannelCount();
+        sfinfo.frames = wav.getFrameCount();
     }
-
-    ofstream *out = 0;
-    if (outfilename != "")
+    else
     {
-        out = new ofstream(outfilename.c_str(), ios::out);
-        if (!*out)
+        sndfile = sf_open(wavname.c_str(), SFM_READ, &sfinfo);
+        if (!sndfile)
         {
-            cerr << programName << ": ERROR: Failed to open output file \""
-                    << outfilename << "\" for writing" << endl;
-            delete out;
+            cerr << programName << ": ERROR: Failed to open input file \""
+                    << wavname << "\": " << sf_strerror(sndfile) << endl;
             return 1;
         }
     }
 
-    Plugin *plugin = loader->loadPlugin
-            (key, sfinfo.samplerate, PluginLoader::ADAPT_ALL_SAFE);
-    if (!plugin)
+    //features go to stdout if there is no output file
+    bool toFile = (outfilename != "");
+    featureWriter out(featureWriter::formatForFile(outfilename));
+    if (!out.open(outfilename, useFrames))
     {
-        cerr << programName << ": ERROR: Failed to load plugin \"" << "percussion onset"
-                << "\" from library \"" << "Vamp-example-sdk" << "\"" << endl;
-        sf_close(sndfile);
-        if (out)
-        {
-            out->close();
-            delete out;
-        }
+        cerr << programName << ": ERROR: Failed to open output file \""
+                << outfilename << "\" for writing" << endl;
+        if (sndfile) sf_close(sndfile);
         return 1;
     }
 
-    cerr << "Running plugin: \"" << plugin->getIdentifier() << "\"..." << endl;
-
-    plugin->setParameter("threshold", 13);
-    plugin->setParameter("sensitivity", 35);
-
-    int blockSize = plugin->getPreferredBlockSize();
-    int stepSize = plugin->getPreferredStepSize();
-
-    if (blockSize == 0)
+    int channels = sfinfo.channels;
+    int blockSize = 0;
+    int stepSize = 0;
+
+    decimation = decimator::supportedFactor(decimation);
+
+    //a decimated stream is mixed down to what the plugin takes before
+    //it is filtered, rather than filtering channels the plugin's channel
+    //adapter would only average or drop; the channel counts come from
+    //the loader's index, without loading the plugin
+    int plugChannels = channels;
+    size_t minChannels = 0, maxChannels = 0;
+    if (decimation > 1 &&
+        pluginPool::getInstance()->getChannelRange(key, minChannels, maxChannels) &&
+        maxChannels > 0 && size_t(channels) > maxChannels)
     {
-        blockSize = 1024;
+        plugChannels = int(maxChannels);
     }
-    if (stepSize == 0)
-    {
-        if (plugin->getInputDomain() == Plugin::FrequencyDomain)
-        {
-            stepSize = blockSize / 2;
-        }
-        else
-        {
-            stepSize = blockSize;
-        }
-    }
-    else if (stepSize > blockSize)
+
+    Plugin *plugin = pluginPool::getInstance()->acquire
+            (key, float(sfinfo.samplerate) / decimation, plugChannels, parameters,
+             blockSize, stepSize);
+    if (!plugin)
     {
-        cerr << "WARNING: stepSize " << stepSize << " > blockSize " << blockSize << ", resetting blockSize to ";
-        if (plugin->getInputDomain() == Plugin::FrequencyDomain)
-        {
-            blockSize = stepSize * 2;
-        }
-        else
-        {
-            blockSize = stepSize;
-        }
-        cerr << blockSize << endl;
+        cerr << programName << ": ERROR: Failed to load plugin \"" << key
+                << "\"" << endl;
+        if (sndfile) sf_close(sndfile);
+        return 1;
     }
-    int overlapSize = blockSize - stepSize;
+
+    if (verbose) cerr << "Running plugin: \"" << plugin->getIdentifier() << "\"..." << endl;
+
     sf_count_t currentStep = 0;
     int finalStepsRemaining = max(1, (blockSize / stepSize) - 1); // at end of file, this many part-silent frames needed after we hit EOF
 
-    int channels = sfinfo.channels;
+    //anything libsndfile reads, and anything decimated, is decoded on a
+    //separate thread, ahead of the plugin
+    decodeStage *decoder = 0;
+    if (sndfile)
+    {
+        decoder = new decodeStage(sndfile, channels, blockSize, stepSize,
+                                  decimation, plugChannels);
+    }
+    else if (decimation > 1)
+    {
+        decoder = new decodeStage(&wav, blockSize, stepSize, decimation,
+                                  plugChannels);
+    }
 
-    float *filebuf = new float[blockSize * channels];
     float **plugbuf = new float*[channels];
     for (int c = 0; c < channels; ++c) plugbuf[c] = new float[blockSize + 2];
 
-    cerr << "Using block size = " << blockSize << ", step size = "
-            << stepSize << endl;
-
-    int minch = plugin->getMinChannelCount();
-    int maxch = plugin->getMaxChannelCount();
-    cerr << "Plugin accepts " << minch << " -> " << maxch << " channel(s)" << endl;
-    cerr << "Sound file has " << channels << " (will mix/augment if necessary)" << endl;
+    if (verbose)
+    {
+        cerr << "Using block size = " << blockSize << ", step size = "
+                << stepSize;
+        if (decimation > 1) cerr << ", decimated by " << decimation;
+        cerr << endl;
+
+        int minch = plugin->getMinChannelCount();
+        int maxch = plugin->getMaxChannelCount();
+        cerr << "Plugin accepts " << minch << " -> " << maxch << " channel(s)" << endl;
+        cerr << "Sound file has " << channels << " (will mix/augment if necessary)" << endl;
+        if (plugChannels != channels)
+        {
+            cerr << "Mixing down to " << plugChannels << " before decimating" << endl;
+        }
+    }
 
     Plugin::OutputList outputs = plugin->getOutputDescriptors();
     Plugin::OutputDescriptor od;
@@ -546,559 +581,662 @@ int runPluginPercussionOnset(string programName,
 
     int returnValue = 1;
     int progress = 0;
+    int featureCount = -1;
 
     RealTime rt;
-    PluginWrapper *wrapper = 0;
+    RealTime::FrameConverter frames(sfinfo.samplerate);
     RealTime adjustment = RealTime::zeroTime;
 
     od = outputs[outputNo];
-    cerr << "Output is: \"" << od.identifier << "\"" << endl;
+    if (verbose) cerr << "Output is: \"" << od.identifier << "\"" << endl;
+    out.setOutput(outputNo, od);
 
-    plugin->initialise(channels, stepSize, blockSize);
+    // See documentation for
+    // PluginInputDomainAdapter::getTimestampAdjustment
+    InputAdapterChain *chain = dynamic_cast<InputAdapterChain *> (plugin);
+    if (chain) adjustment = chain->getTimestampAdjustment();
 
-
-    wrapper = dynamic_cast<PluginWrapper *> (plugin);
-    if (wrapper)
-    {
-        // See documentation for
-        // PluginInputDomainAdapter::getTimestampAdjustment
-        PluginInputDomainAdapter *ida =
-                wrapper->getWrapper<PluginInputDomainAdapter>();
-        if (ida) adjustment = ida->getTimestampAdjustment();
-    }
+    bool stopped = false;
 
     // Here we iterate over the frames, avoiding asking the numframes in case it's streaming input.
-    do
+    while (true)
     {
+        float **block = plugbuf;
 
-        int count;
+        if (stopAnalysis.load(std::memory_order_relaxed))
+        {
+            stopped = true;
+            break;
+        }
 
-        if ((blockSize == stepSize) || (currentStep == 0))
+        if (decoder)
         {
-            // read a full fresh block
-            if ((count = sf_readf_float(sndfile, filebuf, blockSize)) < 0)
-            {
-                cerr << "ERROR: sf_readf_float failed: " << sf_strerror(sndfile) << endl;
-                break;
-            }
-            if (count != blockSize) --finalStepsRemaining;
+            if (!(block = decoder->next())) break;
         }
         else
         {
-            //  otherwise shunt the existing data down and read the remainder.
-            memmove(filebuf, filebuf + (stepSize * channels), overlapSize * channels * sizeof (float));
-            if ((count = sf_readf_float(sndfile, filebuf + (overlapSize * channels), stepSize)) < 0)
-            {
-                cerr << "ERROR: sf_readf_float failed: " << sf_strerror(sndfile) << endl;
-                break;
-            }
-            if (count != stepSize) --finalStepsRemaining;
-            count += overlapSize;
-        }
+            if (finalStepsRemaining == 0) break;
 
-        for (int c = 0; c < channels; ++c)
-        {
-            int j = 0;
-            while (j < count)
-            {
-                plugbuf[c][j] = filebuf[j * sfinfo.channels + c];
-                ++j;
-            }
-            while (j < blockSize)
-            {
-                plugbuf[c][j] = 0.0f;
-                ++j;
-            }
+            // convert the block straight from the mapping; anything past
+            // the end of the file comes out as silence
+            sf_count_t start = currentStep * stepSize;
+            wav.read(start, blockSize, plugbuf);
+            if (start + blockSize > sfinfo.frames) --finalStepsRemaining;
         }
 
-        rt = RealTime::frame2RealTime(currentStep * stepSize, sfinfo.samplerate);
+        //block timestamps are taken at the file's rate
+        rt = frames.toRealTime(currentStep * stepSize * decimation);
 
-        features = plugin->process(plugbuf, rt);
+        features = plugin->process(block, rt);
 
         printFeatures
-                (RealTime::realTime2Frame(rt + adjustment, sfinfo.samplerate),
-                 sfinfo.samplerate, od, outputNo, features, out, useFrames);
+                (frames.toFrame(rt + adjustment),
+                 sfinfo.samplerate, od, outputNo, features, out, useFrames,
+                 featureCount);
 
         if (sfinfo.frames > 0)
         {
             int pp = progress;
-            progress = (int) ((float(currentStep * stepSize) / sfinfo.frames) * 100.f + 0.5f);
-            if (progress != pp && out)
+            progress = (int) ((float(currentStep * stepSize * decimation) / sfinfo.frames) * 100.f + 0.5f);
+            if (progress != pp && toFile && verbose)
             {
                 cerr << "\r" << progress << "%";
             }
         }
 
         ++currentStep;
+    }
 
+    if (decoder && decoder->failed())
+    {
+        cerr << "ERROR: sf_readf_float failed: " << decoder->getError() << endl;
     }
-    while (finalStepsRemaining > 0);
 
-    if (out) cerr << "\rDone" << endl;
+    if (!stopped)
+    {
+        if (toFile && verbose) cerr << "\rDone" << endl;
 
-    rt = RealTime::frame2RealTime(currentStep * stepSize, sfinfo.samplerate);
+        rt = frames.toRealTime(currentStep * stepSize * decimation);
 
-    features = plugin->getRemainingFeatures();
+        features = plugin->getRemainingFeatures();
 
-    printFeatures(RealTime::realTime2Frame(rt + adjustment, sfinfo.samplerate),
-                  sfinfo.samplerate, od, outputNo, features, out, useFrames);
+        printFeatures(frames.toFrame(rt + adjustment),
+                      sfinfo.samplerate, od, outputNo, features, out, useFrames,
+                      featureCount);
 
-    returnValue = 0;
+        returnValue = 0;
+    }
 
-done:
-    delete plugin;
-    if (out)
+    pluginPool::getInstance()->release(plugin);
+    for (int c = 0; c < channels; ++c) delete[] plugbuf[c];
+    delete[] plugbuf;
+    delete decoder;
+    if (!out.close())
     {
-        out->close();
-        delete out;
+        cerr << programName << ": ERROR: Failed to write output file \""
+                << outfilename << "\"" << endl;
+        returnValue = 1;
     }
-    sf_close(sndfile);
+    if (sndfile) sf_close(sndfile);
     return returnValue;
 }
 
-int runPluginTempo(string programName,
-                   string output, int outputNo, string wavname,
-                   string outfilename, bool useFrames)
+//Runs the plugin as runPlugin does, but splits the file into chunks of
+//consecutive blocks that are processed at the same time on a taskPool,
+//each by its own instance. That is only valid for a plugin whose state
+//after warmupBlocks consecutive blocks no longer depends on anything
+//before them: each chunk first runs the warmupBlocks blocks before its
+//start and drops their features, so by its first block its instance is
+//where a serial run's would be. The features are then written out
+//chunk by chunk, in order, and come out the same as runPlugin's. Input
+//that can't be read from the middle goes to runPlugin instead.
+
+int runPluginChunked(string programName, PluginLoader::PluginKey key,
+                     const parameterMap &parameters, int outputNo,
+                     string wavname, string outfilename, bool useFrames,
+                     int warmupBlocks, int threads)
 {
-    PluginLoader *loader = PluginLoader::getInstance();
-
-    PluginLoader::PluginKey key = loader->composePluginKey("Vamp-example-plugins", "fixedtempo");
-
-    SNDFILE *sndfile;
+    mappedWav wav;
     SF_INFO sfinfo;
     memset(&sfinfo, 0, sizeof (SF_INFO));
 
-    sndfile = sf_open(wavname.c_str(), SFM_READ, &sfinfo);
-    if (!sndfile)
+    if (wav.open(wavname))
     {
-        cerr << programName << ": ERROR: Failed to open input file \""
-                << wavname << "\": " << sf_strerror(sndfile) << endl;
-        return 1;
+        sfinfo.samplerate = wav.getSampleRate();
+        sfinfo.channels = wav.getChannelCount();
+        sfinfo.frames = wav.getFrameCount();
     }
-
-    ofstream *out = 0;
-    if (outfilename != "")
+    else
     {
-        out = new ofstream(outfilename.c_str(), ios::out);
-        if (!*out)
+        //each chunk opens the file itself and seeks to where it starts
+        SNDFILE *sndfile = sf_open(wavname.c_str(), SFM_READ, &sfinfo);
+        if (sndfile) sf_close(sndfile);
+        if (!sndfile || !sfinfo.seekable || sfinfo.frames <= 0)
         {
-            cerr << programName << ": ERROR: Failed to open output file \""
-                    << outfilename << "\" for writing" << endl;
-            delete out;
-            return 1;
+            return runPlugin(programName, key, parameters, outputNo,
+                             wavname, outfilename, useFrames, 1);
         }
     }
 
-    Plugin *plugin = loader->loadPlugin
-            (key, sfinfo.samplerate, PluginLoader::ADAPT_ALL_SAFE);
-    if (!plugin)
+    featureWriter out(featureWriter::formatForFile(outfilename));
+    if (!out.open(outfilename, useFrames))
     {
-        cerr << programName << ": ERROR: Failed to load plugin \"" << "percussion onset"
-                << "\" from library \"" << "Vamp-example-sdk" << "\"" << endl;
-        sf_close(sndfile);
-        if (out)
-        {
-            out->close();
-            delete out;
-        }
+        cerr << programName << ": ERROR: Failed to open output file \""
+                << outfilename << "\" for writing" << endl;
         return 1;
     }
 
-    cerr << "Running plugin: \"" << plugin->getIdentifier() << "\"..." << endl;
-
-    plugin->setParameter("maxdflen", 30);
-
-    int blockSize = plugin->getPreferredBlockSize();
-    int stepSize = plugin->getPreferredStepSize();
+    int channels = sfinfo.channels;
+    int blockSize = 0;
+    int stepSize = 0;
 
-    if (blockSize == 0)
+    Plugin *plugin = pluginPool::getInstance()->acquire
+            (key, sfinfo.samplerate, channels, parameters, blockSize, stepSize);
+    if (!plugin)
     {
-        blockSize = 1024;
+        cerr << programName << ": ERROR: Failed to load plugin \"" << key
+                << "\"" << endl;
+        return 1;
     }
-    if (stepSize == 0)
+
+    // the number of blocks a serial run processes, counting the
+    // part-silent ones after the end of the file
+    long totalBlocks = 0;
+    int finalStepsRemaining = max(1, (blockSize / stepSize) - 1);
+    do
     {
-        if (plugin->getInputDomain() == Plugin::FrequencyDomain)
-        {
-            stepSize = blockSize / 2;
-        }
-        else
-        {
-            stepSize = blockSize;
-        }
+        if (totalBlocks * stepSize + blockSize > sfinfo.frames) --finalStepsRemaining;
+        ++totalBlocks;
     }
-    else if (stepSize > blockSize)
-    {
-        cerr << "WARNING: stepSize " << stepSize << " > blockSize " << blockSize << ", resetting blockSize to ";
-        if (plugin->getInputDomain() == Plugin::FrequencyDomain)
-        {
-            blockSize = stepSize * 2;
-        }
-        else
-        {
-            blockSize = stepSize;
-        }
-        cerr << blockSize << endl;
-    }
-    int overlapSize = blockSize - stepSize;
-    sf_count_t currentStep = 0;
-    int finalStepsRemaining = max(1, (blockSize / stepSize) - 1); // at end of file, this many part-silent frames needed after we hit EOF
-
-    int channels = sfinfo.channels;
-
-    float *filebuf = new float[blockSize * channels];
-    float **plugbuf = new float*[channels];
-    for (int c = 0; c < channels; ++c) plugbuf[c] = new float[blockSize + 2];
+    while (finalStepsRemaining > 0);
 
-    cerr << "Using block size = " << blockSize << ", step size = "
-            << stepSize << endl;
+    //two chunks a thread to even out the load, but each long enough
+    //that its warm-up is a small part of it
+    taskPool pool(threads);
+    long chunkCount = min(long(pool.getThreadCount()) * 2,
+                          max(1L, totalBlocks / (16L * (warmupBlocks + 1))));
+    long chunkBlocks = (totalBlocks + chunkCount - 1) / chunkCount;
+    chunkCount = (totalBlocks + chunkBlocks - 1) / chunkBlocks;
 
-    int minch = plugin->getMinChannelCount();
-    int maxch = plugin->getMaxChannelCount();
-    cerr << "Plugin accepts " << minch << " -> " << maxch << " channel(s)" << endl;
-    cerr << "Sound file has " << channels << " (will mix/augment if necessary)" << endl;
+    if (verbose)
+    {
+        cerr << "Running plugin: \"" << plugin->getIdentifier() << "\" in "
+                << chunkCount << " chunk(s) on " << pool.getThreadCount()
+                << " thread(s)..." << endl;
+    }
 
     Plugin::OutputList outputs = plugin->getOutputDescriptors();
-    Plugin::OutputDescriptor od;
-    Plugin::FeatureSet features;
+    Plugin::OutputDescriptor od = outputs[outputNo];
+    out.setOutput(outputNo, od);
 
-    int returnValue = 1;
-    int progress = 0;
-
-    RealTime rt;
-    PluginWrapper *wrapper = 0;
     RealTime adjustment = RealTime::zeroTime;
+    InputAdapterChain *chain = dynamic_cast<InputAdapterChain *> (plugin);
+    if (chain) adjustment = chain->getTimestampAdjustment();
 
-    od = outputs[outputNo];
-    cerr << "Output is: \"" << od.identifier << "\"" << endl;
-
-    plugin->initialise(channels, stepSize, blockSize);
+    RealTime::FrameConverter frames(sfinfo.samplerate);
 
+    struct chunk {
+        long begin, end;
+        vector<Plugin::FeatureSet> features; //output outputNo only, one per block
+        Plugin::FeatureSet remaining;
+        bool failed;
+    };
+    vector<chunk> chunks(chunkCount);
 
-    wrapper = dynamic_cast<PluginWrapper *> (plugin);
-    if (wrapper)
+    for (long i = 0; i < chunkCount; ++i)
     {
-        // See documentation for
-        // PluginInputDomainAdapter::getTimestampAdjustment
-        PluginInputDomainAdapter *ida =
-                wrapper->getWrapper<PluginInputDomainAdapter>();
-        if (ida) adjustment = ida->getTimestampAdjustment();
-    }
+        chunk &ch = chunks[i];
+        ch.begin = i * chunkBlocks;
+        ch.end = min(totalBlocks, ch.begin + chunkBlocks);
+        ch.failed = false;
 
-    // Here we iterate over the frames, avoiding asking the numframes in case it's streaming input.
-    do
-    {
+        pool.add([&, i]()
+        {
+            chunk &ch = chunks[i];
+            int b = blockSize, s = stepSize;
 
-        int count;
+            //the first chunk has the instance acquired above
+            Plugin *p = (i == 0 ? plugin : pluginPool::getInstance()->acquire
+                         (key, sfinfo.samplerate, channels, parameters, b, s));
+            if (!p)
+            {
+                ch.failed = true;
+                return;
+            }
 
-        if ((blockSize == stepSize) || (currentStep == 0))
-        {
-            // read a full fresh block
-            if ((count = sf_readf_float(sndfile, filebuf, blockSize)) < 0)
+            long from = max(0L, ch.begin - warmupBlocks);
+
+            SNDFILE *sndfile = 0;
+            decodeStage *decoder = 0;
+            if (!wav.isOpen())
             {
-                cerr << "ERROR: sf_readf_float failed: " << sf_strerror(sndfile) << endl;
-                break;
+                SF_INFO info;
+                memset(&info, 0, sizeof (SF_INFO));
+                sndfile = sf_open(wavname.c_str(), SFM_READ, &info);
+                if (!sndfile || sf_seek(sndfile, from * stepSize, SEEK_SET) < 0)
+                {
+                    if (sndfile) sf_close(sndfile);
+                    pluginPool::getInstance()->release(p);
+                    ch.failed = true;
+                    return;
+                }
+                decoder = new decodeStage(sndfile, channels, blockSize, stepSize);
             }
-            if (count != blockSize) --finalStepsRemaining;
-        }
-        else
-        {
-            //  otherwise shunt the existing data down and read the remainder.
-            memmove(filebuf, filebuf + (stepSize * channels), overlapSize * channels * sizeof (float));
-            if ((count = sf_readf_float(sndfile, filebuf + (overlapSize * channels), stepSize)) < 0)
+
+            float **plugbuf = new float*[channels];
+            for (int c = 0; c < channels; ++c) plugbuf[c] = new float[blockSize + 2];
+
+            ch.features.reserve(ch.end - ch.begin);
+
+            for (long k = from; k < ch.end; ++k)
             {
-                cerr << "ERROR: sf_readf_float failed: " << sf_strerror(sndfile) << endl;
-                break;
+                if (stopAnalysis.load(std::memory_order_relaxed))
+                {
+                    ch.failed = true;
+                    break;
+                }
+
+                float **block = plugbuf;
+                if (decoder)
+                {
+                    //every block up to ch.end is in the file, so running
+                    //out early is a read error, and going on would leave
+                    //a hole in the middle of the output
+                    if (!(block = decoder->next()))
+                    {
+                        ch.failed = true;
+                        break;
+                    }
+                }
+                else
+                {
+                    wav.read(k * stepSize, blockSize, plugbuf);
+                }
+
+                Plugin::FeatureSet features = p->process(block, frames.toRealTime(k * stepSize));
+                if (k < ch.begin) continue;
+
+                ch.features.push_back(Plugin::FeatureSet());
+                Plugin::FeatureSet::iterator f = features.find(outputNo);
+                if (f != features.end()) ch.features.back()[outputNo].swap(f->second);
             }
-            if (count != stepSize) --finalStepsRemaining;
-            count += overlapSize;
-        }
 
-        for (int c = 0; c < channels; ++c)
-        {
-            int j = 0;
-            while (j < count)
+            if (decoder && decoder->failed())
             {
-                plugbuf[c][j] = filebuf[j * sfinfo.channels + c];
-                ++j;
+                cerr << "ERROR: sf_readf_float failed: " << decoder->getError() << endl;
+                ch.failed = true;
             }
-            while (j < blockSize)
+
+            if (ch.end == totalBlocks && !ch.failed)
             {
-                plugbuf[c][j] = 0.0f;
-                ++j;
+                ch.remaining = p->getRemainingFeatures();
             }
-        }
 
-        rt = RealTime::frame2RealTime(currentStep * stepSize, sfinfo.samplerate);
+            pluginPool::getInstance()->release(p);
+            for (int c = 0; c < channels; ++c) delete[] plugbuf[c];
+            delete[] plugbuf;
+            delete decoder;
+            if (sndfile) sf_close(sndfile);
+        });
+    }
 
-        features = plugin->process(plugbuf, rt);
+    pool.run();
 
-        printFeatures
-                (RealTime::realTime2Frame(rt + adjustment, sfinfo.samplerate),
-                 sfinfo.samplerate, od, outputNo, features, out, useFrames);
+    int returnValue = 0;
+    int featureCount = -1;
+    RealTime rt;
 
-        if (sfinfo.frames > 0)
+    for (long i = 0; i < chunkCount; ++i)
+    {
+        const chunk &ch = chunks[i];
+        if (ch.failed)
         {
-            int pp = progress;
-            progress = (int) ((float(currentStep * stepSize) / sfinfo.frames) * 100.f + 0.5f);
-            if (progress != pp && out)
+            if (!stopAnalysis.load(std::memory_order_relaxed))
             {
-                cerr << "\r" << progress << "%";
+                cerr << programName << ": ERROR: Failed to analyse blocks "
+                        << ch.begin << " to " << ch.end - 1 << " of \"" << wavname
+                        << "\"" << endl;
             }
+            returnValue = 1;
+            break;
         }
 
-        ++currentStep;
+        for (size_t j = 0; j < ch.features.size(); ++j)
+        {
+            rt = frames.toRealTime((ch.begin + long(j)) * stepSize);
 
+            printFeatures
+                    (frames.toFrame(rt + adjustment),
+                     sfinfo.samplerate, od, outputNo, ch.features[j], out, useFrames,
+                     featureCount);
+        }
     }
-    while (finalStepsRemaining > 0);
-
-    if (out) cerr << "\rDone" << endl;
-
-    rt = RealTime::frame2RealTime(currentStep * stepSize, sfinfo.samplerate);
-
-    features = plugin->getRemainingFeatures();
 
-    printFeatures(RealTime::realTime2Frame(rt + adjustment, sfinfo.samplerate),
-                  sfinfo.samplerate, od, outputNo, features, out, useFrames);
+    if (returnValue == 0)
+    {
+        rt = frames.toRealTime(totalBlocks * stepSize);
 
-    returnValue = 0;
+        printFeatures(frames.toFrame(rt + adjustment),
+                      sfinfo.samplerate, od, outputNo, chunks.back().remaining, out, useFrames,
+                      featureCount);
+    }
 
-done:
-    delete plugin;
-    if (out)
+    if (!out.close())
     {
-        out->close();
-        delete out;
+        cerr << programName << ": ERROR: Failed to write output file \""
+                << outfilename << "\"" << endl;
+        returnValue = 1;
     }
-    sf_close(sndfile);
     return returnValue;
 }
 
+int runPluginPercussionOnset(string programName,
+                             string output, int outputNo, string wavname,
+                             string outfilename, bool useFrames,
+                             int decimation = 1)
+{
+    PluginLoader *loader = PluginLoader::getInstance();
+
+    PluginLoader::PluginKey key = loader->composePluginKey("Vamp-example-plugins", "percussiononsets");
+
+    parameterMap parameters;
+    parameters["threshold"] = 13;
+    parameters["sensitivity"] = 35;
+
+    return runPlugin(programName, key, parameters, outputNo,
+                     wavname, outfilename, useFrames, decimation);
+}
+
+//percussion onsets through runPluginChunked. The detector carries
+//nothing from block to block but the previous block's bin energies and
+//its last two detection function values, so after three blocks a fresh
+//instance is in exactly the state a serial run would be.
+
+int runPluginPercussionOnsetChunked(string programName,
+                                    string output, int outputNo, string wavname,
+                                    string outfilename, bool useFrames,
+                                    int threads = 0)
+{
+    PluginLoader *loader = PluginLoader::getInstance();
+
+    PluginLoader::PluginKey key = loader->composePluginKey("Vamp-example-plugins", "percussiononsets");
+
+    parameterMap parameters;
+    parameters["threshold"] = 13;
+    parameters["sensitivity"] = 35;
+
+    return runPluginChunked(programName, key, parameters, outputNo,
+                            wavname, outfilename, useFrames, 3, threads);
+}
+
+int runPluginTempo(string programName,
+                   string output, int outputNo, string wavname,
+                   string outfilename, bool useFrames,
+                   int decimation = 1)
+{
+    PluginLoader *loader = PluginLoader::getInstance();
+
+    PluginLoader::PluginKey key = loader->composePluginKey("Vamp-example-plugins", "fixedtempo");
+
+    parameterMap parameters;
+    parameters["maxdflen"] = 30;
+
+    return runPlugin(programName, key, parameters, outputNo,
+                     wavname, outfilename, useFrames, decimation);
+}
+
 int runPluginZeroCrossing(string programName,
                           string output, int outputNo, string wavname,
-                          string outfilename, bool useFrames)
+                          string outfilename, bool useFrames,
+                          int decimation = 1)
 {
     PluginLoader *loader = PluginLoader::getInstance();
 
     PluginLoader::PluginKey key = loader->composePluginKey("Vamp-example-plugins", "zerocrossing");
 
-    SNDFILE *sndfile;
-    SF_INFO sfinfo;
-    memset(&sfinfo, 0, sizeof (SF_INFO));
+    return runPlugin(programName, key, parameterMap(), outputNo,
+                     wavname, outfilename, useFrames, decimation);
+}
 
-    sndfile = sf_open(wavname.c_str(), SFM_READ, &sfinfo);
-    if (!sndfile)
+//true if the file name has an extension libsndfile can usually read
+
+static bool isAudioFile(const string &name)
+{
+    static const char *const extensions[] = {
+        "wav", "aif", "aiff", "flac", "ogg", "au", "snd", "caf", "w64"
+    };
+
+    size_t dot = name.rfind('.');
+    if (dot == string::npos) return false;
+    string ext = name.substr(dot + 1);
+    for (size_t i = 0; i < ext.length(); ++i) ext[i] = tolower(ext[i]);
+
+    for (size_t i = 0; i < sizeof (extensions) / sizeof (extensions[0]); ++i)
     {
-        cerr << programName << ": ERROR: Failed to open input file \""
-                << wavname << "\": " << sf_strerror(sndfile) << endl;
-        return 1;
+        if (ext == extensions[i]) return true;
     }
+    return false;
+}
 
-    ofstream *out = 0;
-    if (outfilename != "")
+//adds path to files, or if it is a directory the audio files in it
+
+static void listAudioFiles(const string &path, vector<string> &files)
+{
+    DIR *d = opendir(path.c_str());
+    if (!d)
     {
-        out = new ofstream(outfilename.c_str(), ios::out);
-        if (!*out)
-        {
-            cerr << programName << ": ERROR: Failed to open output file \""
-                    << outfilename << "\" for writing" << endl;
-            delete out;
-            return 1;
-        }
+        files.push_back(path);
+        return;
     }
 
-    Plugin *plugin = loader->loadPlugin
-            (key, sfinfo.samplerate, PluginLoader::ADAPT_ALL_SAFE);
-    if (!plugin)
+    vector<string> found;
+    struct dirent *e;
+    while ((e = readdir(d)) != 0)
     {
-        cerr << programName << ": ERROR: Failed to load plugin \"" << "percussion onset"
-                << "\" from library \"" << "Vamp-example-sdk" << "\"" << endl;
-        sf_close(sndfile);
-        if (out)
-        {
-            out->close();
-            delete out;
-        }
-        return 1;
+        string name = e->d_name;
+        if (name[0] == '.' || !isAudioFile(name)) continue;
+        found.push_back(path + "/" + name);
     }
+    closedir(d);
 
-    cerr << "Running plugin: \"" << plugin->getIdentifier() << "\"..." << endl;
+    sort(found.begin(), found.end());
+    files.insert(files.end(), found.begin(), found.end());
+}
 
-    int blockSize = plugin->getPreferredBlockSize();
-    int stepSize = plugin->getPreferredStepSize();
+//runs the three analyses over every file given, one file per task on
+//a taskPool, writing <name>.percussionOnsets.txt, <name>.zerocrossings.txt
+//and <name>.fixedtempo.txt into outdir (or beside each file if outdir
+//is empty). The onset and zero crossing analyses run decimated by
+//decimation; tempo always runs at the file's rate. Returns the number
+//of files that failed.
 
-    if (blockSize == 0)
-    {
-        blockSize = 1024;
-    }
-    if (stepSize == 0)
-    {
-        if (plugin->getInputDomain() == Plugin::FrequencyDomain)
-        {
-            stepSize = blockSize / 2;
-        }
-        else
-        {
-            stepSize = blockSize;
-        }
-    }
-    else if (stepSize > blockSize)
+int runBatch(string programName, const vector<string> &paths,
+             string outdir, int threads, int decimation)
+{
+    vector<string> files;
+    for (size_t i = 0; i < paths.size(); ++i)
     {
-        cerr << "WARNING: stepSize " << stepSize << " > blockSize " << blockSize << ", resetting blockSize to ";
-        if (plugin->getInputDomain() == Plugin::FrequencyDomain)
-        {
-            blockSize = stepSize * 2;
-        }
-        else
-        {
-            blockSize = stepSize;
-        }
-        cerr << blockSize << endl;
+        listAudioFiles(paths[i], files);
     }
-    int overlapSize = blockSize - stepSize;
-    sf_count_t currentStep = 0;
-    int finalStepsRemaining = max(1, (blockSize / stepSize) - 1); // at end of file, this many part-silent frames needed after we hit EOF
 
-    int channels = sfinfo.channels;
+    if (outdir != "") mkdir(outdir.c_str(), 0777);
 
-    float *filebuf = new float[blockSize * channels];
-    float **plugbuf = new float*[channels];
-    for (int c = 0; c < channels; ++c) plugbuf[c] = new float[blockSize + 2];
-
-    cerr << "Using block size = " << blockSize << ", step size = "
-            << stepSize << endl;
+    verbose = false;
 
-    int minch = plugin->getMinChannelCount();
-    int maxch = plugin->getMaxChannelCount();
-    cerr << "Plugin accepts " << minch << " -> " << maxch << " channel(s)" << endl;
-    cerr << "Sound file has " << channels << " (will mix/augment if necessary)" << endl;
+    //the plugin loader is created on first use, unguarded, and every
+    //task asks it for plugin keys, so have it exist before they start
+    PluginLoader::getInstance();
 
-    Plugin::OutputList outputs = plugin->getOutputDescriptors();
-    Plugin::OutputDescriptor od;
-    Plugin::FeatureSet features;
+    taskPool pool(threads);
+    std::atomic<int> failures(0);
+    std::mutex reportMutex;
 
-    int returnValue = 1;
-    int progress = 0;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        string file = files[i];
+        pool.add([&, file]()
+        {
+            size_t slash = file.rfind('/');
+            string name = (slash == string::npos ? file : file.substr(slash + 1));
+            string dir = (slash == string::npos ? "." : file.substr(0, slash));
+            size_t dot = name.rfind('.');
+            if (dot != string::npos) name = name.substr(0, dot);
+
+            string prefix = (outdir != "" ? outdir : dir) + "/" + name;
+
+            int result = runPluginPercussionOnset(programName, "", 0, file,
+                                                  prefix + ".percussionOnsets.txt", false,
+                                                  decimation);
+            result += runPluginZeroCrossing(programName, "", 0, file,
+                                            prefix + ".zerocrossings.txt", false,
+                                            decimation);
+            result += runPluginTempo(programName, "", 0, file,
+                                     prefix + ".fixedtempo.txt", false);
+
+            std::lock_guard<std::mutex> lock(reportMutex);
+            if (result)
+            {
+                ++failures;
+                cerr << programName << ": FAILED: " << file << endl;
+            }
+            else
+            {
+                cerr << file << endl;
+            }
+        });
+    }
 
-    RealTime rt;
-    PluginWrapper *wrapper = 0;
-    RealTime adjustment = RealTime::zeroTime;
+    cerr << "Analysing " << files.size() << " file(s) on "
+            << pool.getThreadCount() << " thread(s)" << endl;
 
-    od = outputs[outputNo];
-    cerr << "Output is: \"" << od.identifier << "\"" << endl;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    pool.run();
+    double seconds = std::chrono::duration<double>
+            (std::chrono::steady_clock::now() - start).count();
 
-    plugin->initialise(channels, stepSize, blockSize);
+    cerr << "Analysed " << files.size() << " file(s), " << failures
+            << " failed, in " << seconds << "s (";
+    if (seconds > 0) cerr << files.size() / seconds;
+    else cerr << "-";
+    cerr << " files/sec)" << endl;
 
+    pluginPool::getInstance()->clear();
+    verbose = true;
 
-    wrapper = dynamic_cast<PluginWrapper *> (plugin);
-    if (wrapper)
-    {
-        // See documentation for
-        // PluginInputDomainAdapter::getTimestampAdjustment
-        PluginInputDomainAdapter *ida =
-                wrapper->getWrapper<PluginInputDomainAdapter>();
-        if (ida) adjustment = ida->getTimestampAdjustment();
-    }
+    return failures;
+}
 
-    // Here we iterate over the frames, avoiding asking the numframes in case it's streaming input.
-    do
-    {
+//batch [-t threads] [-o outdir] [-d decimation] <file or directory>...
 
-        int count;
+int batchMain(string programName, int argc, char **argv)
+{
+    int threads = 0;
+    int decimation = 1;
+    string outdir = "";
+    vector<string> paths;
 
-        if ((blockSize == stepSize) || (currentStep == 0))
+    for (int i = 0; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "-t" && i + 1 < argc)
         {
-            // read a full fresh block
-            if ((count = sf_readf_float(sndfile, filebuf, blockSize)) < 0)
-            {
-                cerr << "ERROR: sf_readf_float failed: " << sf_strerror(sndfile) << endl;
-                break;
-            }
-            if (count != blockSize) --finalStepsRemaining;
+            threads = atoi(argv[++i]);
         }
-        else
+        else if (arg == "-o" && i + 1 < argc)
         {
-            //  otherwise shunt the existing data down and read the remainder.
-            memmove(filebuf, filebuf + (stepSize * channels), overlapSize * channels * sizeof (float));
-            if ((count = sf_readf_float(sndfile, filebuf + (overlapSize * channels), stepSize)) < 0)
-            {
-                cerr << "ERROR: sf_readf_float failed: " << sf_strerror(sndfile) << endl;
-                break;
-            }
-            if (count != stepSize) --finalStepsRemaining;
-            count += overlapSize;
+            outdir = argv[++i];
         }
-
-        for (int c = 0; c < channels; ++c)
+        else if (arg == "-d" && i + 1 < argc)
         {
-            int j = 0;
-            while (j < count)
-            {
-                plugbuf[c][j] = filebuf[j * sfinfo.channels + c];
-                ++j;
-            }
-            while (j < blockSize)
-            {
-                plugbuf[c][j] = 0.0f;
-                ++j;
-            }
+            decimation = atoi(argv[++i]);
         }
-
-        rt = RealTime::frame2RealTime(currentStep * stepSize, sfinfo.samplerate);
-
-        features = plugin->process(plugbuf, rt);
-
-        printFeatures
-                (RealTime::realTime2Frame(rt + adjustment, sfinfo.samplerate),
-                 sfinfo.samplerate, od, outputNo, features, out, useFrames);
-
-        if (sfinfo.frames > 0)
+        else
         {
-            int pp = progress;
-            progress = (int) ((float(currentStep * stepSize) / sfinfo.frames) * 100.f + 0.5f);
-            if (progress != pp && out)
-            {
-                cerr << "\r" << progress << "%";
-            }
+            paths.push_back(arg);
         }
+    }
 
-        ++currentStep;
-
+    if (paths.empty())
+    {
+        cerr << "Usage: " << programName
+                << " batch [-t threads] [-o outdir] [-d decimation] <file or directory>..." << endl;
+        return 2;
     }
-    while (finalStepsRemaining > 0);
 
-    if (out) cerr << "\rDone" << endl;
+    if (decimation < 1 || decimation != decimator::supportedFactor(decimation))
+    {
+        cerr << programName << ": ERROR: decimation must be 1, 2, 4, 8..." << endl;
+        return 2;
+    }
 
-    rt = RealTime::frame2RealTime(currentStep * stepSize, sfinfo.samplerate);
+    return runBatch(programName, paths, outdir, threads, decimation) ? 1 : 0;
+}
 
-    features = plugin->getRemainingFeatures();
+//prints a columnar feature file (see featurecolumns.h) as text
 
-    printFeatures(RealTime::realTime2Frame(rt + adjustment, sfinfo.samplerate),
-                  sfinfo.samplerate, od, outputNo, features, out, useFrames);
+int dumpColumns(string programName, string filename)
+{
+    columnReader reader;
+    if (!reader.open(filename))
+    {
+        cerr << programName << ": ERROR: Failed to read feature file \""
+                << filename << "\"" << endl;
+        return 1;
+    }
 
-    returnValue = 0;
+    featureWriter out;
+    out.open("", reader.usesFrames());
 
-done:
-    delete plugin;
-    if (out)
+    for (int i = 0; i < reader.getOutputCount(); ++i)
     {
-        out->close();
-        delete out;
+        const Plugin::OutputDescriptor &od = reader.getDescriptor(i);
+        cout << "# output " << reader.getOutputNumber(i) << " \"" << od.identifier
+                << "\": " << reader.getRowCount(i) << " feature(s)" << endl;
+
+        column<int64_t> times = reader.getTimes(i);
+        column<int64_t> durations = reader.getDurations(i);
+        column<int32_t> labels = reader.getLabelIndices(i);
+
+        for (size_t r = 0; r < times.size; ++r)
+        {
+            Plugin::Feature f;
+            column<float> values = reader.getRow(i, r);
+            f.values.assign(values.begin(), values.end());
+            column<char> label = reader.getLabel(i, labels[r]);
+            f.label.assign(label.begin(), label.end());
+            f.hasDuration = (durations[r] >= 0);
+
+            if (reader.usesFrames())
+            {
+                out.write(long(times[r]), long(durations[r]), f);
+            }
+            else
+            {
+                f.duration = RealTime(int(durations[r] / 1000000000),
+                                      int(durations[r] % 1000000000));
+                out.write(RealTime(int(times[r] / 1000000000),
+                                   int(times[r] % 1000000000)), f);
+            }
+        }
+        out.close();
+        out.open("", reader.usesFrames());
     }
-    sf_close(sndfile);
-    return returnValue;
+
+    return out.close() ? 0 : 1;
 }
 
-void createEvents()
+eventTimeline::specList *createEvents()
 {
+    eventTimeline::specList *specs = new eventTimeline::specList;
+
     string line = "";
     ifstream myfile ("/home/edward/NetBeansProjects/SoundTesting/dist/Debug/GNU-Linux/percussionOnsets.txt");
     if(myfile.is_open())
     {
         while(getline(myfile,line))
         {
-            event* newEvent = new event(std::atof(line.c_str()), 1, 5);
-            //newEvent = event(std::atof(line.c_str()), 1, 5);
-            eventVector.push_back(newEvent);
+            eventTimeline::eventSpec newEvent = { float(std::atof(line.c_str())), 1, 5 };
+            specs->push_back(newEvent);
         }
         myfile.close();
     }
@@ -1110,36 +1248,112 @@ void createEvents()
     {
         while(getline(myfile3,line))
         {
-            //event* newEvent = new event(std::atof(line.c_str()), 3, 5);
-            //eventVector.push_back(*newEvent);
+            //eventTimeline::eventSpec newEvent = { float(std::atof(line.c_str())), 3, 5 };
+            //specs->push_back(newEvent);
         }
         myfile3.close();
     }
     
+    return specs;
+}
+
+//runs the onset analysis of song.wav with the input decimated by
+//decimation (at full resolution split across all the cores), then
+//publishes the events made from it
+
+int analyseOnsets(string &DebugOutput, int decimation)
+{
+    int exit;
+    if (decimation > 1)
+    {
+        exit = runPluginPercussionOnset("VRConcert", DebugOutput, 0, "/home/edward/NetBeansProjects/SoundTesting/dist/Debug/GNU-Linux/song.wav",
+                                        "/home/edward/NetBeansProjects/SoundTesting/dist/Debug/GNU-Linux/percussionOnsets.txt", false,
+                                        decimation);
+    }
+    else
+    {
+        exit = runPluginPercussionOnsetChunked("VRConcert", DebugOutput, 0, "/home/edward/NetBeansProjects/SoundTesting/dist/Debug/GNU-Linux/song.wav",
+                                               "/home/edward/NetBeansProjects/SoundTesting/dist/Debug/GNU-Linux/percussionOnsets.txt", false);
+    }
+
+    //a pass cut short by quitting leaves nothing worth showing
+    if (!stopAnalysis.load(std::memory_order_relaxed))
+    {
+        timeline.publish(createEvents());
+    }
+    return exit;
+}
+
+//the refinement behind the show: full-resolution onsets replace the
+//provisional ones, then zero crossings and tempo, which the events
+//aren't made from yet, at the file's own rate
+
+void refineSong()
+{
+    string refineOutput = "";
+    int exit = analyseOnsets(refineOutput, 1);
+
+    if (!stopAnalysis.load(std::memory_order_relaxed))
+    {
+        exit += runPluginZeroCrossing("VRConcert", refineOutput, 0, "/home/edward/NetBeansProjects/SoundTesting/dist/Debug/GNU-Linux/song.wav",
+                                      "/home/edward/NetBeansProjects/SoundTesting/dist/Debug/GNU-Linux/zerocrossings.txt", false);
+    }
+    if (!stopAnalysis.load(std::memory_order_relaxed))
+    {
+        exit += runPluginTempo("VRConcert", refineOutput, 0, "/home/edward/NetBeansProjects/SoundTesting/dist/Debug/GNU-Linux/song.wav",
+                               "/home/edward/NetBeansProjects/SoundTesting/dist/Debug/GNU-Linux/fixedtempo.txt", false);
+    }
+
+    if (exit && !stopAnalysis.load(std::memory_order_relaxed))
+    {
+        cerr << "VRConcert: ERROR: Full-resolution analysis failed" << endl;
+    }
+
+    //the analysis is done, so the idle plugin instances can go
+    pluginPool::getInstance()->clear();
+}
+
+//registered with atexit once the refinement starts, so it runs however
+//the show ends (Escape, the Quit menu or closing the window) and before
+//the plugin loader, the timeline or anything else the refinement is
+//using has been destroyed
+
+void stopRefinement()
+{
+    stopAnalysis.store(true, std::memory_order_relaxed);
+    if (refine.joinable()) refine.join();
 }
 
 int main(int argc, char** argv)
 {
+    //headless analysis of many files, no window or audio
+    if (argc > 1 && string(argv[1]) == "batch")
+    {
+        return batchMain("VRConcert", argc - 2, argv + 2);
+    }
+    if (argc > 2 && string(argv[1]) == "dump")
+    {
+        return dumpColumns("VRConcert", argv[2]);
+    }
+
     //enumeratePlugins(PluginInformationDetailed);
     SDLSetup = 0;
     
 
     string DebugOutput = "";
 
-    int exit = runPluginPercussionOnset("VRConcert", DebugOutput, 0, "/home/edward/NetBeansProjects/SoundTesting/dist/Debug/GNU-Linux/song.wav",
-                                        "/home/edward/NetBeansProjects/SoundTesting/dist/Debug/GNU-Linux/percussionOnsets.txt", false);
-
-    exit += runPluginZeroCrossing("VRConcert", DebugOutput, 0, "/home/edward/NetBeansProjects/SoundTesting/dist/Debug/GNU-Linux/song.wav",
-                                  "/home/edward/NetBeansProjects/SoundTesting/dist/Debug/GNU-Linux/zerocrossings.txt", false);
-
-    exit += runPluginTempo("VRConcert", DebugOutput, 0, "/home/edward/NetBeansProjects/SoundTesting/dist/Debug/GNU-Linux/song.wav",
-                           "/home/edward/NetBeansProjects/SoundTesting/dist/Debug/GNU-Linux/fixedtempo.txt", false);
+    //a coarse onset pass over the audio decimated by 4 gives provisional
+    //events to open the show with
+    int exit = analyseOnsets(DebugOutput, 4);
 
     cout << "Debug output: " << DebugOutput << " exit: " << exit;
 
-    
-    createEvents();
-    
+    //then everything else runs behind the show at full resolution, and
+    //the refined onsets replace the provisional ones when they are done
+    verbose = false;
+    refine = std::thread(refineSong);
+    atexit(stopRefinement);
+
 
     t.start();
     
@@ -1182,6 +1396,16 @@ void initializeGraphics(void)
     lon = 0;
     lat = 0;
 
+    stage.create();
+    if (!fountains.create())
+    {
+        cerr << "No GLSL 1.20: fountains will be drawn on the CPU" << endl;
+    }
+
+    //1 is a fountain, 2 a tempo pulse (nothing to draw yet) and 3 a
+    //zero crossing
+    effects.add(1, fountainRenderer::drawBatch, &fountains);
+    effects.add(3, drawSpheres, 0);
 
     glutCreateMenu(menu);
     glutAddMenuEntry("Quit", 1);
@@ -1223,39 +1447,25 @@ void display(void)
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 
-    glBegin(GL_POLYGON);
-    glColor3f(0.0, 0.0, 0.5);
-    glVertex3f(-8000.0, 0.0, -8000.0);
-    glVertex3f(8000.0, 0.0, -8000.0);
-    glVertex3f(8000.0, 0.0, 8000.0);
-    glVertex3f(-8000.0, 0.0, 8000.0);
-    glEnd();
-
-
-    glColor3f(0.0, 1.0, 0.0);
-
-    glutWireSphere(4000, 30, 30);
+    stage.draw();
 
     //cerr << "\n" << t.elapsedTime();
     
-    for (int i = 0; i < eventVector.size(); i++)
+    //pick up any events the analysis has refined since the last frame
+    if (timeline.update())
     {
-        
-        if (eventVector.at(i)->startTime <= t.elapsedTime() 
-                && eventVector.at(i)->endTime >= t.elapsedTime())
-        {
-            cerr << "\nStarted: " << eventVector.at(i)->startTime;
-            eventVector.at(i)->eventAnimate();
-        }
-        else
-        {
-           // cerr << "\nFailed: " << eventVector.at(i)->startTime
-                   // << " , " << eventVector.at(i)->endTime;
-        }
-        
-
+        fountains.setEvents(timeline.getEvents(), timeline.getPayload());
     }
+    const std::vector<event> &events = timeline.getEvents();
+    float now = t.elapsedTime();
 
+    size_t first, last;
+    timeline.activeRange(now, first, last);
+    //only what the camera can see, in as much detail as its distance
+    //warrants
+    viewFrustum view;
+    view.take();
+    effects.draw(events, first, last, now, &view);
 
     glLoadIdentity();
     calculate_lookpoint(); /* Compute the centre of interest   */
@@ -1303,6 +1513,26 @@ void keyboard(unsigned char key, int x, int y)
     calculate_lookpoint();
 }
 
+//zero crossings {vocals}: a sphere at each event's origin
+
+void drawSpheres(const std::vector<event> &events,
+                 const std::vector<effectTable::item> &batch, float,
+                 void *)
+{
+    for (size_t i = 0; i < batch.size(); i++)
+    {
+        const event &e = events[batch[i].index];
+        GLfloat r, g, b;
+
+        e.getColour(r, g, b);
+        glColor3f(r, g, b);
+        glPushMatrix();
+        glTranslatef(e.getOriginX(), 0, e.getOriginZ());
+        glutSolidSphere(20, 10, 10);
+        glPopMatrix();
+    }
+}
+
 void animate(void)
 {
     
@@ -0,0 +1,271 @@
+
+#include "mappedwav.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static uint16_t le16(const unsigned char *p)
+{
+    return uint16_t(p[0] | (p[1] << 8));
+}
+
+static uint32_t le32(const unsigned char *p)
+{
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) |
+            (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+mappedWav::mappedWav() :
+    mapped(0),
+    length(0),
+    data(0),
+    enc(pcm16),
+    sampleRate(0),
+    channels(0),
+    bytesPerFrame(0),
+    frames(0)
+{
+}
+
+bool mappedWav::open(const std::string &filename)
+{
+    close();
+
+    //samples are converted in place assuming a little-endian host
+    const uint16_t one = 1;
+    if (*(const unsigned char *) &one != 1) return false;
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < 44)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void *m = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (m == MAP_FAILED) return false;
+
+    mapped = (const unsigned char *) m;
+    length = st.st_size;
+
+    if (!parse())
+    {
+        close();
+        return false;
+    }
+
+    //analysis reads the file front to back, so ask for read-ahead
+    madvise(m, length, MADV_SEQUENTIAL);
+    return true;
+}
+
+bool mappedWav::parse()
+{
+    if (memcmp(mapped, "RIFF", 4) != 0 || memcmp(mapped + 8, "WAVE", 4) != 0)
+    {
+        return false;
+    }
+
+    bool haveFormat = false;
+    int bits = 0;
+    size_t pos = 12;
+
+    while (pos + 8 <= length)
+    {
+        const unsigned char *chunk = mapped + pos;
+        size_t size = le32(chunk + 4);
+        const unsigned char *body = chunk + 8;
+        size_t available = length - (pos + 8);
+
+        if (memcmp(chunk, "fmt ", 4) == 0)
+        {
+            if (size < 16 || size > available) return false;
+
+            int format = le16(body);
+            channels = le16(body + 2);
+            sampleRate = le32(body + 4);
+            bytesPerFrame = le16(body + 12);
+            bits = le16(body + 14);
+
+            if (format == 0xfffe)
+            {
+                //WAVE_FORMAT_EXTENSIBLE: the real format is the first
+                //two bytes of the subformat GUID
+                if (size < 40) return false;
+                format = le16(body + 24);
+            }
+
+            if (format == 1)
+            {
+                if (bits == 8) enc = pcmU8;
+                else if (bits == 16) enc = pcm16;
+                else if (bits == 24) enc = pcm24;
+                else if (bits == 32) enc = pcm32;
+                else return false;
+            }
+            else if (format == 3)
+            {
+                if (bits == 32) enc = float32;
+                else if (bits == 64) enc = float64;
+                else return false;
+            }
+            else
+            {
+                return false;
+            }
+
+            if (channels <= 0 || sampleRate <= 0 ||
+                    bytesPerFrame != channels * (bits / 8))
+            {
+                return false;
+            }
+            haveFormat = true;
+        }
+        else if (memcmp(chunk, "data", 4) == 0)
+        {
+            if (!haveFormat) return false;
+            //a streamed or truncated file may claim more than is there
+            if (size > available) size = available;
+            data = body;
+            frames = size / bytesPerFrame;
+            return true;
+        }
+
+        pos += 8 + size + (size & 1);
+    }
+
+    return false;
+}
+
+void mappedWav::close()
+{
+    if (mapped)
+    {
+        munmap((void *) mapped, length);
+    }
+    mapped = 0;
+    length = 0;
+    data = 0;
+    frames = 0;
+}
+
+bool mappedWav::isOpen() const
+{
+    return mapped != 0;
+}
+
+int mappedWav::getSampleRate() const
+{
+    return sampleRate;
+}
+
+int mappedWav::getChannelCount() const
+{
+    return channels;
+}
+
+long mappedWav::getFrameCount() const
+{
+    return frames;
+}
+
+void mappedWav::read(long start, int count, float *const *buffers) const
+{
+    int n = 0;
+    if (start < frames)
+    {
+        n = (frames - start < count ? int(frames - start) : count);
+    }
+    if (start < 0) n = 0;
+
+    const unsigned char *base = data + start * bytesPerFrame;
+
+    for (int c = 0; c < channels; ++c)
+    {
+        float *out = buffers[c];
+
+        switch (enc)
+        {
+        case pcmU8:
+        {
+            const unsigned char *p = base + c;
+            for (int i = 0; i < n; ++i, p += bytesPerFrame)
+            {
+                out[i] = float(int(*p) - 128) * (1.0f / 0x80);
+            }
+            break;
+        }
+        case pcm16:
+        {
+            const unsigned char *p = base + c * 2;
+            for (int i = 0; i < n; ++i, p += bytesPerFrame)
+            {
+                int16_t s;
+                memcpy(&s, p, 2);
+                out[i] = float(s) * (1.0f / 0x8000);
+            }
+            break;
+        }
+        case pcm24:
+        {
+            const unsigned char *p = base + c * 3;
+            for (int i = 0; i < n; ++i, p += bytesPerFrame)
+            {
+                int32_t s = int32_t((uint32_t(p[0]) << 8) | (uint32_t(p[1]) << 16) |
+                                    (uint32_t(p[2]) << 24));
+                out[i] = float(s) * (1.0f / 0x80000000u);
+            }
+            break;
+        }
+        case pcm32:
+        {
+            const unsigned char *p = base + c * 4;
+            for (int i = 0; i < n; ++i, p += bytesPerFrame)
+            {
+                int32_t s;
+                memcpy(&s, p, 4);
+                out[i] = float(s) * (1.0f / 0x80000000u);
+            }
+            break;
+        }
+        case float32:
+        {
+            const unsigned char *p = base + c * 4;
+            for (int i = 0; i < n; ++i, p += bytesPerFrame)
+            {
+                memcpy(&out[i], p, 4);
+            }
+            break;
+        }
+        case float64:
+        {
+            const unsigned char *p = base + c * 8;
+            for (int i = 0; i < n; ++i, p += bytesPerFrame)
+            {
+                double d;
+                memcpy(&d, p, 8);
+                out[i] = float(d);
+            }
+            break;
+        }
+        }
+
+        for (int i = n; i < count; ++i)
+        {
+            out[i] = 0.0f;
+        }
+    }
+}
+
+mappedWav::~mappedWav()
+{
+    close();
+}
@@ -0,0 +1,49 @@
+
+#ifndef MAPPEDWAV_H
+#define MAPPEDWAV_H
+
+#include <string>
+
+//Reads uncompressed WAV files (8, 16, 24 or 32 bit integer PCM, or 32
+//or 64 bit float, plain or WAVE_FORMAT_EXTENSIBLE) by mapping them
+//into memory and converting samples straight into per-channel float
+//buffers, scaled as libsndfile's sf_readf_float would. Anything else
+//fails to open and should go through libsndfile instead.
+class mappedWav {
+public:
+    mappedWav();
+    virtual ~mappedWav();
+
+    bool open(const std::string &filename);
+    void close();
+    bool isOpen() const;
+
+    int getSampleRate() const;
+    int getChannelCount() const;
+    long getFrameCount() const;
+
+    //Write frames start to start + count - 1 into buffers, one per
+    //channel. Frames beyond the end of the file come out as zero.
+    void read(long start, int count, float *const *buffers) const;
+
+private:
+    mappedWav(const mappedWav &);
+    mappedWav &operator=(const mappedWav &);
+
+    enum encoding {
+        pcmU8, pcm16, pcm24, pcm32, float32, float64
+    };
+
+    bool parse();
+
+    const unsigned char *mapped;
+    size_t length;
+    const unsigned char *data;
+    encoding enc;
+    int sampleRate;
+    int channels;
+    int bytesPerFrame;
+    long frames;
+};
+
+#endif /* MAPPEDWAV_H */
@@ -35,17 +35,30 @@ OBJECTDIR=${CND_BUILDDIR}/${CND_CONF}/${CND_PLATFORM}
 
 # Object Files
 OBJECTFILES= \
+	${OBJECTDIR}/counterrandom.o \
+	${OBJECTDIR}/decimator.o \
+	${OBJECTDIR}/decodestage.o \
+	${OBJECTDIR}/effecttable.o \
 	${OBJECTDIR}/event.o \
+	${OBJECTDIR}/eventtimeline.o \
+	${OBJECTDIR}/featurecolumns.o \
+	${OBJECTDIR}/featurewriter.o \
+	${OBJECTDIR}/fountainrenderer.o \
 	${OBJECTDIR}/main.o \
-	${OBJECTDIR}/timer.o
+	${OBJECTDIR}/mappedwav.o \
+	${OBJECTDIR}/pluginpool.o \
+	${OBJECTDIR}/stagegeometry.o \
+	${OBJECTDIR}/taskpool.o \
+	${OBJECTDIR}/timer.o \
+	${OBJECTDIR}/viewfrustum.o
 
 
 # C Compiler Flags
 CFLAGS=
 
 # CC Compiler Flags
-CCFLAGS=-m64 -lvamp-hostsdk -ldl -lsndfile -lGL -lGLU -lglut -pipe -lX11 -lm -DFX -DXMESA -lSDL2main -lSDL2 -O3
-CXXFLAGS=-m64 -lvamp-hostsdk -ldl -lsndfile -lGL -lGLU -lglut -pipe -lX11 -lm -DFX -DXMESA -lSDL2main -lSDL2 -O3
+CCFLAGS=-m64 -lvamp-hostsdk -ldl -lpthread -lsndfile -lGL -lGLU -lglut -pipe -lX11 -lm -DFX -DXMESA -lSDL2main -lSDL2 -O3
+CXXFLAGS=-m64 -lvamp-hostsdk -ldl -lpthread -lsndfile -lGL -lGLU -lglut -pipe -lX11 -lm -DFX -DXMESA -lSDL2main -lSDL2 -O3
 
 # Fortran Compiler Flags
 FFLAGS=
@@ -64,21 +77,86 @@ ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/soundtesting: ${OBJECTFILES}
 	${MKDIR} -p ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}
 	${LINK.cc} -o ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/soundtesting ${OBJECTFILES} ${LDLIBSOPTIONS}
 
+${OBJECTDIR}/counterrandom.o: counterrandom.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/counterrandom.o counterrandom.cpp
+
+${OBJECTDIR}/decimator.o: decimator.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/decimator.o decimator.cpp
+
+${OBJECTDIR}/decodestage.o: decodestage.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/decodestage.o decodestage.cpp
+
+${OBJECTDIR}/effecttable.o: effecttable.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/effecttable.o effecttable.cpp
+
 ${OBJECTDIR}/event.o: event.cpp
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
 	$(COMPILE.cc) -g -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/event.o event.cpp
 
+${OBJECTDIR}/eventtimeline.o: eventtimeline.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/eventtimeline.o eventtimeline.cpp
+
+${OBJECTDIR}/featurecolumns.o: featurecolumns.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/featurecolumns.o featurecolumns.cpp
+
+${OBJECTDIR}/featurewriter.o: featurewriter.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/featurewriter.o featurewriter.cpp
+
+${OBJECTDIR}/fountainrenderer.o: fountainrenderer.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/fountainrenderer.o fountainrenderer.cpp
+
 ${OBJECTDIR}/main.o: main.cpp
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
 	$(COMPILE.cc) -g -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/main.o main.cpp
 
+${OBJECTDIR}/mappedwav.o: mappedwav.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/mappedwav.o mappedwav.cpp
+
+${OBJECTDIR}/pluginpool.o: pluginpool.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/pluginpool.o pluginpool.cpp
+
+${OBJECTDIR}/stagegeometry.o: stagegeometry.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/stagegeometry.o stagegeometry.cpp
+
+${OBJECTDIR}/taskpool.o: taskpool.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/taskpool.o taskpool.cpp
+
 ${OBJECTDIR}/timer.o: timer.cpp
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
 	$(COMPILE.cc) -g -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/timer.o timer.cpp
 
+${OBJECTDIR}/viewfrustum.o: viewfrustum.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/viewfrustum.o viewfrustum.cpp
+
 # Subprojects
 .build-subprojects:
 
@@ -0,0 +1,201 @@
+
+#include "pluginpool.h"
+
+#include <vamp-hostsdk/PluginAdapterChain.h>
+
+#include <iostream>
+#include <tuple>
+
+using Vamp::Plugin;
+using Vamp::HostExt::PluginLoader;
+using Vamp::HostExt::InputAdapterChain;
+
+pluginPool::pluginPool()
+{
+}
+
+pluginPool *pluginPool::getInstance()
+{
+    //never deleted: instances must be released before the plugin
+    //loader goes away, so call clear() explicitly instead
+    static pluginPool *instance = new pluginPool();
+    return instance;
+}
+
+bool pluginPool::instanceKey::operator<(const instanceKey &k) const
+{
+    return std::tie(key, sampleRate, channels, blockSize, stepSize, parameters)
+            < std::tie(k.key, k.sampleRate, k.channels, k.blockSize, k.stepSize, k.parameters);
+}
+
+Plugin *pluginPool::load(const instanceKey &k)
+{
+    //the input domain and channel adapters, composed at compile time.
+    //There is no buffering adapter, so the sizes have to be ones the
+    //plugin accepts as they are.
+    Plugin *plugin = PluginLoader::getInstance()->loadPlugin
+            (k.key, k.sampleRate, 0);
+    if (!plugin) return 0;
+    plugin = new InputAdapterChain(plugin);
+
+    for (parameterMap::const_iterator i = k.parameters.begin();
+            i != k.parameters.end(); ++i)
+    {
+        plugin->setParameter(i->first, i->second);
+    }
+    return plugin;
+}
+
+void pluginPool::chooseSizes(Plugin *plugin, int &blockSize, int &stepSize)
+{
+    blockSize = plugin->getPreferredBlockSize();
+    stepSize = plugin->getPreferredStepSize();
+
+    if (blockSize == 0)
+    {
+        blockSize = 1024;
+    }
+    if (stepSize == 0)
+    {
+        if (plugin->getInputDomain() == Plugin::FrequencyDomain)
+        {
+            stepSize = blockSize / 2;
+        }
+        else
+        {
+            stepSize = blockSize;
+        }
+    }
+    else if (stepSize > blockSize)
+    {
+        std::cerr << "WARNING: stepSize " << stepSize << " > blockSize " << blockSize << ", resetting blockSize to ";
+        if (plugin->getInputDomain() == Plugin::FrequencyDomain)
+        {
+            blockSize = stepSize * 2;
+        }
+        else
+        {
+            blockSize = stepSize;
+        }
+        std::cerr << blockSize << std::endl;
+    }
+}
+
+Plugin *pluginPool::acquire(const PluginLoader::PluginKey &key,
+                            float sampleRate, int channels,
+                            const parameterMap &parameters,
+                            int &blockSize, int &stepSize)
+{
+    //the plugin loader is not thread-safe, so loading happens under
+    //the pool lock too
+    std::lock_guard<std::mutex> lock(mutex);
+
+    instanceKey k;
+    k.key = key;
+    k.sampleRate = sampleRate;
+    k.channels = channels;
+    k.blockSize = blockSize;
+    k.stepSize = stepSize;
+    k.parameters = parameters;
+
+    Plugin *plugin = 0;
+
+    if (blockSize == 0 || stepSize == 0)
+    {
+        instanceKey request = k;
+        request.blockSize = 0;
+        request.stepSize = 0;
+        auto sizes = preferredSizes.find(request);
+        if (sizes == preferredSizes.end())
+        {
+            //need an instance to ask, which we can then go on to use
+            plugin = load(k);
+            if (!plugin) return 0;
+            int block = 0, step = 0;
+            chooseSizes(plugin, block, step);
+            sizes = preferredSizes.insert
+                    (std::make_pair(request, std::make_pair(block, step))).first;
+        }
+        if (blockSize == 0) k.blockSize = sizes->second.first;
+        if (stepSize == 0) k.stepSize = sizes->second.second;
+    }
+
+    blockSize = k.blockSize;
+    stepSize = k.stepSize;
+
+    if (!plugin)
+    {
+        auto i = idle.find(k);
+        if (i != idle.end())
+        {
+            plugin = i->second;
+            idle.erase(i);
+            busy[plugin] = k;
+            return plugin;
+        }
+        plugin = load(k);
+        if (!plugin) return 0;
+    }
+
+    if (!plugin->initialise(channels, stepSize, blockSize))
+    {
+        std::cerr << "ERROR: Plugin \"" << key << "\" failed to initialise with "
+                << channels << " channel(s), step size " << stepSize
+                << " and block size " << blockSize << std::endl;
+        delete plugin;
+        return 0;
+    }
+
+    busy[plugin] = k;
+    return plugin;
+}
+
+bool pluginPool::getChannelRange(const PluginLoader::PluginKey &key,
+                                 size_t &minChannels, size_t &maxChannels)
+{
+    //looking a plugin up can enumerate libraries and rewrite the
+    //loader's index, so it is serialised with loading
+    std::lock_guard<std::mutex> lock(mutex);
+
+    Vamp::HostExt::PluginStaticData data =
+            PluginLoader::getInstance()->getPluginStaticData(key);
+    if (data.pluginKey == "") return false;
+
+    minChannels = data.minChannelCount;
+    maxChannels = data.maxChannelCount;
+    return true;
+}
+
+void pluginPool::release(Plugin *plugin)
+{
+    if (!plugin) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto i = busy.find(plugin);
+    if (i == busy.end())
+    {
+        delete plugin;
+        return;
+    }
+
+    plugin->reset();
+    idle.insert(std::make_pair(i->second, plugin));
+    busy.erase(i);
+}
+
+void pluginPool::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto i = idle.begin(); i != idle.end(); ++i)
+    {
+        delete i->second;
+    }
+    idle.clear();
+}
+
+pluginPool::~pluginPool()
+{
+    clear();
+}
@@ -0,0 +1,69 @@
+#ifndef PLUGINPOOL_H
+#define PLUGINPOOL_H
+
+#include <vamp-hostsdk/Plugin.h>
+#include <vamp-hostsdk/PluginLoader.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+
+//parameter values to set on a plugin before it is initialised
+typedef std::map<std::string, float> parameterMap;
+
+//Keeps initialised plugin instances for reuse, keyed by plugin key,
+//sample rate, channel count, block size, step size and parameters.
+//Analysing many files with the same plugins then only pays for
+//loading and initialising each configuration once; between uses an
+//instance is just reset().
+class pluginPool {
+public:
+    static pluginPool *getInstance();
+
+    //Hand out an initialised instance, loading one if none is idle.
+    //A blockSize or stepSize of 0 selects the plugin's preferred size,
+    //and both are updated to the sizes the instance was initialised
+    //with. Other sizes are passed to the plugin unbuffered, so must be
+    //ones it accepts. Returns 0 if the plugin can't be loaded or initialised.
+    Vamp::Plugin *acquire(const Vamp::HostExt::PluginLoader::PluginKey &key,
+                          float sampleRate, int channels,
+                          const parameterMap &parameters,
+                          int &blockSize, int &stepSize);
+
+    //the smallest and largest channel counts the plugin takes, from
+    //the loader's index, without loading it. Returns false if the
+    //plugin isn't known.
+    bool getChannelRange(const Vamp::HostExt::PluginLoader::PluginKey &key,
+                         size_t &minChannels, size_t &maxChannels);
+
+    //reset an instance from acquire() and make it available again
+    void release(Vamp::Plugin *plugin);
+
+    //delete all idle instances
+    void clear();
+
+    virtual ~pluginPool();
+private:
+    pluginPool();
+
+    struct instanceKey {
+        Vamp::HostExt::PluginLoader::PluginKey key;
+        float sampleRate;
+        int channels;
+        int blockSize, stepSize;
+        parameterMap parameters;
+        bool operator<(const instanceKey &k) const;
+    };
+
+    Vamp::Plugin *load(const instanceKey &k);
+    static void chooseSizes(Vamp::Plugin *plugin, int &blockSize, int &stepSize);
+
+    std::multimap<instanceKey, Vamp::Plugin *> idle;
+    std::map<Vamp::Plugin *, instanceKey> busy;
+    //sizes chosen for requests that asked for preferred sizes, keyed
+    //by the request (with block and step size 0)
+    std::map<instanceKey, std::pair<int, int> > preferredSizes;
+    std::mutex mutex;
+};
+
+#endif
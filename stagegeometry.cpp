@@ -0,0 +1,123 @@
+
+//for the buffer object entry points
+#define GL_GLEXT_PROTOTYPES
+
+#include "stagegeometry.h"
+
+#include <cmath>
+
+stageGeometry::stageGeometry()
+{
+}
+
+void stageGeometry::create()
+{
+    destroy();
+    addGround();
+    addDome();
+}
+
+//the 16000 x 16000 floor the show stands on
+
+void stageGeometry::addGround()
+{
+    const GLfloat ground[] = {
+        -8000.0, 0.0, -8000.0,
+        8000.0, 0.0, -8000.0,
+        8000.0, 0.0, 8000.0,
+        -8000.0, 0.0, 8000.0
+    };
+    addObject(GL_TRIANGLE_FAN,
+              std::vector<GLfloat>(ground, ground + 12), 0.0, 0.0, 0.5);
+}
+
+//a wire sphere of radius 4000 with 30 slices and 30 stacks, laid out
+//as glutWireSphere draws it: a circle at each stack between the poles
+//and a line from pole to pole at each slice
+
+void stageGeometry::addDome()
+{
+    const GLfloat radius = 4000.0;
+    const int slices = 30;
+    const int stacks = 30;
+
+    std::vector<GLfloat> lines;
+    lines.reserve(((stacks - 1) * slices + slices * stacks) * 6);
+
+    //the point at stack i (0 at the +z pole) and slice j
+    auto point = [&](int i, int j)
+    {
+        double theta = M_PI * i / stacks;
+        double phi = 2.0 * M_PI * j / slices;
+        lines.push_back(GLfloat(radius * cos(phi) * sin(theta)));
+        lines.push_back(GLfloat(radius * sin(phi) * sin(theta)));
+        lines.push_back(GLfloat(radius * cos(theta)));
+    };
+
+    for (int i = 1; i < stacks; ++i)
+    {
+        for (int j = 0; j < slices; ++j)
+        {
+            point(i, j);
+            point(i, (j + 1) % slices);
+        }
+    }
+    for (int j = 0; j < slices; ++j)
+    {
+        for (int i = 0; i < stacks; ++i)
+        {
+            point(i, j);
+            point(i + 1, j);
+        }
+    }
+
+    addObject(GL_LINES, lines, 0.0, 1.0, 0.0);
+}
+
+void stageGeometry::addObject(GLenum mode, const std::vector<GLfloat> &vertices,
+                              GLfloat r, GLfloat g, GLfloat b)
+{
+    object o;
+    o.mode = mode;
+    o.count = GLsizei(vertices.size() / 3);
+    o.r = r;
+    o.g = g;
+    o.b = b;
+
+    glGenBuffers(1, &o.buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, o.buffer);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof (GLfloat),
+                 &vertices[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    objects.push_back(o);
+}
+
+void stageGeometry::draw() const
+{
+    glEnableClientState(GL_VERTEX_ARRAY);
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        const object &o = objects[i];
+        glColor3f(o.r, o.g, o.b);
+        glBindBuffer(GL_ARRAY_BUFFER, o.buffer);
+        glVertexPointer(3, GL_FLOAT, 0, 0);
+        glDrawArrays(o.mode, 0, o.count);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+void stageGeometry::destroy()
+{
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        glDeleteBuffers(1, &objects[i].buffer);
+    }
+    objects.clear();
+}
+
+stageGeometry::~stageGeometry()
+{
+    //the GL context may be gone by now, so the buffers are left to it
+}
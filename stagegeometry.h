@@ -0,0 +1,49 @@
+
+#ifndef STAGEGEOMETRY_H
+#define STAGEGEOMETRY_H
+
+#include <GL/gl.h>
+
+#include <vector>
+
+//The parts of the scene that never move - the ground, the sky dome and
+//any other stage props - uploaded once into vertex buffers on the GPU.
+//Drawing an object is then a single glDrawArrays call with nothing sent
+//from the CPU but the call itself.
+class stageGeometry {
+public:
+    stageGeometry();
+    virtual ~stageGeometry();
+
+    //needs a current GL context, so call once the window exists
+    void create();
+
+    //draws every object in the order it was added
+    void draw() const;
+
+    //adds a prop from vertices (x, y, z each) drawn as mode in a
+    //single colour; the vertices are copied to the GPU straight away
+    void addObject(GLenum mode, const std::vector<GLfloat> &vertices,
+                   GLfloat r, GLfloat g, GLfloat b);
+
+    //deletes the buffers; needs the context to still be current
+    void destroy();
+
+private:
+    stageGeometry(const stageGeometry &);
+    stageGeometry &operator=(const stageGeometry &);
+
+    struct object {
+        GLuint buffer;
+        GLenum mode;
+        GLsizei count;
+        GLfloat r, g, b;
+    };
+
+    void addGround();
+    void addDome();
+
+    std::vector<object> objects;
+};
+
+#endif /* STAGEGEOMETRY_H */
@@ -0,0 +1,94 @@
+
+#include "taskpool.h"
+
+#include <thread>
+
+taskPool::taskPool(int threadCount) :
+    next(0)
+{
+    if (threadCount <= 0)
+    {
+        threadCount = std::thread::hardware_concurrency();
+        if (threadCount <= 0) threadCount = 1;
+    }
+    for (int i = 0; i < threadCount; ++i)
+    {
+        workers.push_back(new worker);
+    }
+}
+
+int taskPool::getThreadCount() const
+{
+    return workers.size();
+}
+
+void taskPool::add(std::function<void()> task)
+{
+    //deal tasks out round-robin; stealing evens out the rest
+    worker *w = workers[next];
+    next = (next + 1) % workers.size();
+
+    std::lock_guard<std::mutex> lock(w->mutex);
+    w->tasks.push_back(task);
+}
+
+bool taskPool::take(int index, std::function<void()> &task)
+{
+    worker *w = workers[index];
+    std::lock_guard<std::mutex> lock(w->mutex);
+    if (w->tasks.empty()) return false;
+    task = w->tasks.back();
+    w->tasks.pop_back();
+    return true;
+}
+
+bool taskPool::steal(int index, std::function<void()> &task)
+{
+    int n = workers.size();
+    for (int i = 1; i < n; ++i)
+    {
+        worker *w = workers[(index + i) % n];
+        std::lock_guard<std::mutex> lock(w->mutex);
+        if (w->tasks.empty()) continue;
+        task = w->tasks.front();
+        w->tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void taskPool::work(int index)
+{
+    //tasks don't queue more tasks, so once every queue is empty
+    //there is nothing left to do
+    std::function<void()> task;
+    while (take(index, task) || steal(index, task))
+    {
+        task();
+    }
+}
+
+void taskPool::run()
+{
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < workers.size(); ++i)
+    {
+        threads.push_back(std::thread(&taskPool::work, this, i));
+    }
+
+    //the calling thread works too
+    work(0);
+
+    for (size_t i = 0; i < threads.size(); ++i)
+    {
+        threads[i].join();
+    }
+}
+
+taskPool::~taskPool()
+{
+    for (size_t i = 0; i < workers.size(); ++i)
+    {
+        delete workers[i];
+    }
+}
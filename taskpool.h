@@ -0,0 +1,42 @@
+
+#ifndef TASKPOOL_H
+#define TASKPOOL_H
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+//Runs a set of independent tasks over a fixed number of threads. Each
+//worker has its own queue and takes from the back of it; a worker that
+//runs dry steals from the front of the others, so a few long tasks
+//don't leave the rest of the threads idle.
+class taskPool {
+public:
+    //threadCount <= 0 means one per hardware thread
+    taskPool(int threadCount = 0);
+    virtual ~taskPool();
+
+    int getThreadCount() const;
+
+    //queue a task for the next run()
+    void add(std::function<void()> task);
+
+    //run every queued task, returning when all have finished
+    void run();
+
+private:
+    struct worker {
+        std::deque<std::function<void()> > tasks;
+        std::mutex mutex;
+    };
+
+    void work(int index);
+    bool take(int index, std::function<void()> &task);
+    bool steal(int index, std::function<void()> &task);
+
+    std::vector<worker *> workers;
+    int next;
+};
+
+#endif /* TASKPOOL_H */
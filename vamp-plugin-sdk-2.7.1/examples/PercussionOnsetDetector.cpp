@@ -43,12 +43,18 @@ using std::endl;
 
 #include <cmath>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PERCUSSION_SSE2 1
+#endif
+
 
 PercussionOnsetDetector::PercussionOnsetDetector(float inputSampleRate) :
     Plugin(inputSampleRate),
     m_stepSize(0),
     m_blockSize(0),
     m_threshold(3),
+    m_riseRatio(powf(10.f, 0.3f)),
     m_sensitivity(40),
     m_priorMagnitudes(0),
     m_dfMinus1(0),
@@ -118,6 +124,7 @@ PercussionOnsetDetector::initialise(size_t channels, size_t stepSize, size_t blo
     m_stepSize = stepSize;
     m_blockSize = blockSize;
 
+    delete[] m_priorMagnitudes;
     m_priorMagnitudes = new float[m_blockSize/2];
 
     for (size_t i = 0; i < m_blockSize/2; ++i) {
@@ -185,6 +192,7 @@ PercussionOnsetDetector::setParameter(std::string id, float value)
         if (value < 0) value = 0;
         if (value > 20) value = 20;
         m_threshold = value;
+        m_riseRatio = powf(10.f, m_threshold / 10.f);
     } else if (id == "sensitivity") {
         if (value < 0) value = 0;
         if (value > 100) value = 100;
@@ -233,22 +241,50 @@ PercussionOnsetDetector::process(const float *const *inputBuffers,
 	return FeatureSet();
     }
 
+    // A bin counts if its energy rose by at least m_threshold dB,
+    // i.e. 10 log10(sqrmag / prior) >= threshold.  That is tested as
+    // sqrmag >= prior * 10^(threshold/10) so there is no log per bin.
+
+    const float *in = inputBuffers[0];
+    const size_t n = m_blockSize/2;
+    size_t i = 1;
     int count = 0;
 
-    for (size_t i = 1; i < m_blockSize/2; ++i) {
+#ifdef PERCUSSION_SSE2
+    const __m128 ratio = _mm_set1_ps(m_riseRatio);
+    const __m128 zero = _mm_setzero_ps();
+    __m128i counts = _mm_setzero_si128();
+
+    for (; i + 4 <= n; i += 4) {
+        __m128 a = _mm_loadu_ps(in + i*2);
+        __m128 b = _mm_loadu_ps(in + i*2 + 4);
+        __m128 real = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 imag = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 sqrmag = _mm_add_ps(_mm_mul_ps(real, real),
+                                   _mm_mul_ps(imag, imag));
+        __m128 prior = _mm_loadu_ps(m_priorMagnitudes + i);
+        __m128 rise = _mm_and_ps(_mm_cmpgt_ps(prior, zero),
+                                 _mm_cmpge_ps(sqrmag,
+                                              _mm_mul_ps(prior, ratio)));
+        // true lanes are all ones, i.e. -1
+        counts = _mm_sub_epi32(counts, _mm_castps_si128(rise));
+        _mm_storeu_ps(m_priorMagnitudes + i, sqrmag);
+    }
 
-        float real = inputBuffers[0][i*2];
-        float imag = inputBuffers[0][i*2 + 1];
+    int lanes[4];
+    _mm_storeu_si128((__m128i *)lanes, counts);
+    count = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
 
-        float sqrmag = real * real + imag * imag;
+    for (; i < n; ++i) {
 
-        if (m_priorMagnitudes[i] > 0.f) {
-            float diff = 10.f * log10f(sqrmag / m_priorMagnitudes[i]);
+        float real = in[i*2];
+        float imag = in[i*2 + 1];
 
-//        std::cout << "i=" << i << ", sqrmag=" << sqrmag << ", prior=" << m_priorMagnitudes[i] << ", diff=" << diff << ", threshold=" << m_threshold << " " << (diff >= m_threshold ? "[*]" : "") << std::endl;
+        float sqrmag = real * real + imag * imag;
+        float prior = m_priorMagnitudes[i];
 
-            if (diff >= m_threshold) ++count;
-        }
+        if (prior > 0.f && sqrmag >= prior * m_riseRatio) ++count;
 
         m_priorMagnitudes[i] = sqrmag;
     }
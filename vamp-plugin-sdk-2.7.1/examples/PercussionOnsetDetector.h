@@ -80,6 +80,7 @@ protected:
     size_t m_blockSize;
 
     float  m_threshold;
+    float  m_riseRatio;
     float  m_sensitivity;
     float *m_priorMagnitudes;
     float  m_dfMinus1;
@@ -35,6 +35,7 @@
 */
 
 #include "PowerSpectrum.h"
+#include "SpectralStatistics.h"
 
 using std::string;
 using std::cerr;
@@ -147,15 +148,9 @@ PowerSpectrum::process(const float *const *inputBuffers, Vamp::RealTime)
 
     Feature feature;
     feature.hasTimestamp = false;
-    feature.values.reserve(n); // optional
+    feature.values.resize(n);
 
-    for (size_t i = 0; i < n; ++i) {
-
-	double real = fbuf[i * 2];
-	double imag = fbuf[i * 2 + 1];
-
-        feature.values.push_back(real * real + imag * imag);
-    }
+    SpectralStatistics::calculatePower(fbuf, n, &feature.values[0]);
 
     fs[0].push_back(feature);
 
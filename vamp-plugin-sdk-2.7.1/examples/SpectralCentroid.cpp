@@ -91,7 +91,7 @@ SpectralCentroid::getMaker() const
 int
 SpectralCentroid::getPluginVersion() const
 {
-    return 2;
+    return 3;
 }
 
 string
@@ -109,12 +109,15 @@ SpectralCentroid::initialise(size_t channels, size_t stepSize, size_t blockSize)
     m_stepSize = stepSize;
     m_blockSize = blockSize;
 
+    m_statistics.initialise(m_inputSampleRate, m_blockSize);
+
     return true;
 }
 
 void
 SpectralCentroid::reset()
 {
+    m_statistics.reset();
 }
 
 SpectralCentroid::OutputList
@@ -139,6 +142,23 @@ SpectralCentroid::getOutputDescriptors() const
     d.description = "Centroid of the linear frequency spectrum";
     list.push_back(d);
 
+    d.identifier = "spread";
+    d.name = "Spectral Spread";
+    d.description = "Standard deviation of the linear frequency spectrum about its centroid";
+    list.push_back(d);
+
+    d.identifier = "flux";
+    d.name = "Spectral Flux";
+    d.description = "Sum of the rises in bin magnitude since the previous block";
+    d.unit = "";
+    list.push_back(d);
+
+    d.identifier = "rolloff";
+    d.name = "Spectral Rolloff";
+    d.description = "Frequency below which 85% of the spectral magnitude lies";
+    d.unit = "Hz";
+    list.push_back(d);
+
     return list;
 }
 
@@ -152,26 +172,18 @@ SpectralCentroid::process(const float *const *inputBuffers, Vamp::RealTime)
 	return FeatureSet();
     }
 
-    double numLin = 0.0, numLog = 0.0, denom = 0.0;
-
-    for (size_t i = 1; i <= m_blockSize/2; ++i) {
-	double freq = (double(i) * m_inputSampleRate) / m_blockSize;
-	double real = inputBuffers[0][i*2];
-	double imag = inputBuffers[0][i*2 + 1];
-	double scalemag = sqrt(real * real + imag * imag) / (m_blockSize/2);
-	numLin += freq * scalemag;
-        numLog += log10f(freq) * scalemag;
-	denom += scalemag;
-    }
+    SpectralStatistics::Result stats;
+    m_statistics.process(inputBuffers[0], stats);
 
     FeatureSet returnFeatures;
 
-    if (denom != 0.0) {
-	float centroidLin = float(numLin / denom);
-	float centroidLog = powf(10, float(numLog / denom));
+    Feature feature;
+    feature.hasTimestamp = false;
 
-	Feature feature;
-	feature.hasTimestamp = false;
+    if (stats.valid) {
+
+	float centroidLin = float(stats.linearCentroid);
+	float centroidLog = powf(10, float(stats.logCentroid));
 
         if (!isnan(centroidLog) && !isinf(centroidLog)) {
             feature.values.push_back(centroidLog);
@@ -183,8 +195,20 @@ SpectralCentroid::process(const float *const *inputBuffers, Vamp::RealTime)
             feature.values.push_back(centroidLin);
         }
 	returnFeatures[1].push_back(feature);
+
+        feature.values.clear();
+        feature.values.push_back(float(stats.spread));
+        returnFeatures[2].push_back(feature);
+
+        feature.values.clear();
+        feature.values.push_back(float(stats.rolloff));
+        returnFeatures[4].push_back(feature);
     }
 
+    feature.values.clear();
+    feature.values.push_back(float(stats.flux));
+    returnFeatures[3].push_back(feature);
+
     return returnFeatures;
 }
 
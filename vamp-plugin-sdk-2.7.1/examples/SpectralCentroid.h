@@ -39,9 +39,13 @@
 
 #include "vamp-sdk/Plugin.h"
 
+#include "SpectralStatistics.h"
+
 /**
  * Example plugin that calculates the centre of gravity of the
- * frequency domain representation of each block of audio.
+ * frequency domain representation of each block of audio, along with
+ * the spectral spread, flux and rolloff that fall out of the same
+ * pass.
  */
 
 class SpectralCentroid : public Vamp::Plugin
@@ -72,6 +76,8 @@ public:
 protected:
     size_t m_stepSize;
     size_t m_blockSize;
+
+    SpectralStatistics m_statistics;
 };
 
 
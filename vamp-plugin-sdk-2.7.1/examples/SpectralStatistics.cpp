@@ -0,0 +1,230 @@
+/* -*- c-basic-offset: 4 indent-tabs-mode: nil -*-  vi:set ts=8 sts=4 sw=4: */
+
+/*
+    Vamp
+
+    An API for audio analysis and feature extraction plugins.
+
+    Centre for Digital Music, Queen Mary, University of London.
+    Copyright 2006 Chris Cannam.
+  
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without
+    restriction, including without limitation the rights to use, copy,
+    modify, merge, publish, distribute, sublicense, and/or sell copies
+    of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR
+    ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+    CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+    Except as contained in this notice, the names of the Centre for
+    Digital Music; Queen Mary, University of London; and Chris Cannam
+    shall not be used in advertising or otherwise to promote the sale,
+    use or other dealings in this Software without prior written
+    authorization.
+*/
+
+#include "SpectralStatistics.h"
+
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SPECTRAL_STATISTICS_SSE2 1
+#endif
+
+SpectralStatistics::SpectralStatistics() :
+    m_blockSize(0),
+    m_half(0),
+    m_freq(0),
+    m_logFreq(0),
+    m_magnitudes(0),
+    m_priorMagnitudes(0)
+{
+}
+
+SpectralStatistics::~SpectralStatistics()
+{
+    deallocate();
+}
+
+void
+SpectralStatistics::deallocate()
+{
+    delete[] m_freq;
+    delete[] m_logFreq;
+    delete[] m_magnitudes;
+    delete[] m_priorMagnitudes;
+    m_freq = m_logFreq = m_magnitudes = m_priorMagnitudes = 0;
+}
+
+void
+SpectralStatistics::initialise(float sampleRate, size_t blockSize)
+{
+    deallocate();
+
+    m_blockSize = blockSize;
+    m_half = blockSize / 2;
+
+    m_freq = new double[m_half + 1];
+    m_logFreq = new double[m_half + 1];
+    m_magnitudes = new double[m_half + 1];
+    m_priorMagnitudes = new double[m_half + 1];
+
+    for (size_t i = 0; i <= m_half; ++i) {
+        m_freq[i] = (double(i) * sampleRate) / blockSize;
+        m_logFreq[i] = (i == 0 ? 0.0 : log10f(float(m_freq[i])));
+    }
+
+    reset();
+}
+
+void
+SpectralStatistics::reset()
+{
+    for (size_t i = 0; i <= m_half; ++i) {
+        m_magnitudes[i] = 0.0;
+        m_priorMagnitudes[i] = 0.0;
+    }
+}
+
+void
+SpectralStatistics::calculatePower(const float *spectrum, size_t n, float *power)
+{
+    size_t i = 0;
+
+#ifdef SPECTRAL_STATISTICS_SSE2
+    // Squares and sum are done in double, as in the scalar loop
+    for (; i + 2 <= n; i += 2) {
+        __m128 ri = _mm_loadu_ps(spectrum + i*2);
+        __m128d a = _mm_cvtps_pd(ri);
+        __m128d b = _mm_cvtps_pd(_mm_movehl_ps(ri, ri));
+        a = _mm_mul_pd(a, a);
+        b = _mm_mul_pd(b, b);
+        __m128d p = _mm_add_pd(_mm_unpacklo_pd(a, b), _mm_unpackhi_pd(a, b));
+        _mm_storel_pi((__m64 *)(power + i), _mm_cvtpd_ps(p));
+    }
+#endif
+
+    for (; i < n; ++i) {
+        double real = spectrum[i*2];
+        double imag = spectrum[i*2 + 1];
+        power[i] = float(real * real + imag * imag);
+    }
+}
+
+void
+SpectralStatistics::process(const float *spectrum, Result &result, float *power)
+{
+    const double scale = double(m_half);
+
+    double numLin = 0.0, numLog = 0.0, numSq = 0.0, denom = 0.0, flux = 0.0;
+
+    if (power) {
+        double real = spectrum[0];
+        double imag = spectrum[1];
+        power[0] = float(real * real + imag * imag);
+    }
+
+    size_t i = 1;
+
+#ifdef SPECTRAL_STATISTICS_SSE2
+    const __m128d vscale = _mm_set1_pd(scale);
+    const __m128d vzero = _mm_setzero_pd();
+    __m128d vLin = vzero, vLog = vzero, vSq = vzero, vDenom = vzero, vFlux = vzero;
+
+    for (; i + 1 <= m_half; i += 2) {
+        __m128 ri = _mm_loadu_ps(spectrum + i*2);
+        __m128d a = _mm_cvtps_pd(ri);
+        __m128d b = _mm_cvtps_pd(_mm_movehl_ps(ri, ri));
+        a = _mm_mul_pd(a, a);
+        b = _mm_mul_pd(b, b);
+        __m128d p = _mm_add_pd(_mm_unpacklo_pd(a, b), _mm_unpackhi_pd(a, b));
+        if (power) _mm_storel_pi((__m64 *)(power + i), _mm_cvtpd_ps(p));
+
+        __m128d mag = _mm_div_pd(_mm_sqrt_pd(p), vscale);
+        __m128d freq = _mm_loadu_pd(m_freq + i);
+
+        vLin = _mm_add_pd(vLin, _mm_mul_pd(freq, mag));
+        vLog = _mm_add_pd(vLog, _mm_mul_pd(_mm_loadu_pd(m_logFreq + i), mag));
+        vSq = _mm_add_pd(vSq, _mm_mul_pd(_mm_mul_pd(freq, freq), mag));
+        vDenom = _mm_add_pd(vDenom, mag);
+
+        __m128d rise = _mm_sub_pd(mag, _mm_loadu_pd(m_priorMagnitudes + i));
+        vFlux = _mm_add_pd(vFlux, _mm_max_pd(rise, vzero));
+
+        _mm_storeu_pd(m_magnitudes + i, mag);
+    }
+
+    double lanes[2];
+    _mm_storeu_pd(lanes, vLin);   numLin = lanes[0] + lanes[1];
+    _mm_storeu_pd(lanes, vLog);   numLog = lanes[0] + lanes[1];
+    _mm_storeu_pd(lanes, vSq);    numSq = lanes[0] + lanes[1];
+    _mm_storeu_pd(lanes, vDenom); denom = lanes[0] + lanes[1];
+    _mm_storeu_pd(lanes, vFlux);  flux = lanes[0] + lanes[1];
+#endif
+
+    for (; i <= m_half; ++i) {
+        double real = spectrum[i*2];
+        double imag = spectrum[i*2 + 1];
+        double p = real * real + imag * imag;
+        if (power) power[i] = float(p);
+
+        double mag = sqrt(p) / scale;
+        double freq = m_freq[i];
+
+        numLin += freq * mag;
+        numLog += m_logFreq[i] * mag;
+        numSq += freq * freq * mag;
+        denom += mag;
+
+        double rise = mag - m_priorMagnitudes[i];
+        if (rise > 0.0) flux += rise;
+
+        m_magnitudes[i] = mag;
+    }
+
+    // this frame's magnitudes become the prior for the next
+    double *tmp = m_priorMagnitudes;
+    m_priorMagnitudes = m_magnitudes;
+    m_magnitudes = tmp;
+
+    result.flux = flux;
+
+    if (denom == 0.0) {
+        result.valid = false;
+        result.linearCentroid = 0.0;
+        result.logCentroid = 0.0;
+        result.spread = 0.0;
+        result.rolloff = 0.0;
+        return;
+    }
+
+    result.valid = true;
+    result.linearCentroid = numLin / denom;
+    result.logCentroid = numLog / denom;
+
+    double variance = numSq / denom - result.linearCentroid * result.linearCentroid;
+    result.spread = (variance > 0.0 ? sqrt(variance) : 0.0);
+
+    const double *mags = m_priorMagnitudes;
+    double target = denom * 0.85, cumulative = 0.0;
+    result.rolloff = m_freq[m_half];
+    for (size_t j = 1; j <= m_half; ++j) {
+        cumulative += mags[j];
+        if (cumulative >= target) {
+            result.rolloff = m_freq[j];
+            break;
+        }
+    }
+}
@@ -0,0 +1,102 @@
+/* -*- c-basic-offset: 4 indent-tabs-mode: nil -*-  vi:set ts=8 sts=4 sw=4: */
+
+/*
+    Vamp
+
+    An API for audio analysis and feature extraction plugins.
+
+    Centre for Digital Music, Queen Mary, University of London.
+    Copyright 2006 Chris Cannam.
+  
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without
+    restriction, including without limitation the rights to use, copy,
+    modify, merge, publish, distribute, sublicense, and/or sell copies
+    of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR
+    ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+    CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+    Except as contained in this notice, the names of the Centre for
+    Digital Music; Queen Mary, University of London; and Chris Cannam
+    shall not be used in advertising or otherwise to promote the sale,
+    use or other dealings in this Software without prior written
+    authorization.
+*/
+
+#ifndef _SPECTRAL_STATISTICS_H_
+#define _SPECTRAL_STATISTICS_H_
+
+#include <cstddef>
+
+/**
+ * Spectral descriptors of one frame of frequency-domain input, in
+ * the interleaved re/im layout a FrequencyDomain plugin receives.
+ * Magnitude, power, linear and log centroid, spread, flux and
+ * rolloff all come out of a single pass over the bins, using
+ * frequency and log-frequency tables built once per block size.
+ *
+ * Used by SpectralCentroid and PowerSpectrum.
+ */
+
+class SpectralStatistics
+{
+public:
+    SpectralStatistics();
+    ~SpectralStatistics();
+
+    struct Result {
+        bool   valid;          ///< false if the frame has no energy
+        double linearCentroid; ///< Hz
+        double logCentroid;    ///< log10 of Hz
+        double spread;         ///< Hz, about the linear centroid
+        double flux;           ///< rectified rise in magnitude since the last frame
+        double rolloff;        ///< Hz below which 85% of the magnitude lies
+    };
+
+    void initialise(float sampleRate, size_t blockSize);
+
+    /**
+     * Forget the previous frame, so the next flux is measured from
+     * silence.
+     */
+    void reset();
+
+    /**
+     * Calculate the statistics over bins 1 to blockSize/2.  If power
+     * is non-NULL it also receives the blockSize/2+1 power values,
+     * bin 0 included.
+     */
+    void process(const float *spectrum, Result &result, float *power = 0);
+
+    /**
+     * Write re*re + im*im for the first n bins of spectrum to power.
+     */
+    static void calculatePower(const float *spectrum, size_t n, float *power);
+
+protected:
+    size_t  m_blockSize;
+    size_t  m_half;
+    double *m_freq;
+    double *m_logFreq;
+    double *m_magnitudes;
+    double *m_priorMagnitudes;
+
+    void deallocate();
+
+private:
+    SpectralStatistics(const SpectralStatistics &); // not provided
+    SpectralStatistics &operator=(const SpectralStatistics &); // not provided
+};
+
+#endif
@@ -37,21 +37,30 @@
 #include <vamp-hostsdk/PluginHostAdapter.h>
 
 #include "Files.h"
+#include "Threads.h"
 
 #include <cctype> // tolower
 
 #include <cstring>
+#include <cstdlib>
+#include <cstdio>
+
+#include <sys/types.h>
+#include <sys/stat.h>
 
 #ifdef _WIN32
 
 #include <windows.h>
 #include <tchar.h>
+#include <direct.h>
+#include <process.h>
 #define PLUGIN_SUFFIX "dll"
 
 #else /* ! _WIN32 */
 
 #include <dirent.h>
 #include <dlfcn.h>
+#include <unistd.h>
 
 #ifdef __APPLE__
 #define PLUGIN_SUFFIX "dylib"
@@ -63,6 +72,17 @@
 
 using namespace std;
 
+namespace {
+
+struct ListTask : public Threads::Task
+{
+    string dir;
+    vector<string> files;
+    void run() { files = Files::listFiles(dir, PLUGIN_SUFFIX); }
+};
+
+}
+
 vector<string>
 Files::listLibraryFiles()
 {
@@ -88,11 +108,22 @@ Files::listLibraryFilesMatching(Filter filter)
         libraryNames.push_back(n);
     }
 
+    // Read all of the directories concurrently, as on slow or network
+    // filesystems the listing time is mostly waiting. The results are
+    // then filtered in path order, so the output order is unchanged.
+    vector<ListTask> listings(path.size());
+    vector<Threads::Task *> tasks;
+    for (size_t i = 0; i < path.size(); ++i) {
+        listings[i].dir = path[i];
+        tasks.push_back(&listings[i]);
+    }
+    Threads::runAll(tasks);
+
     for (size_t i = 0; i < path.size(); ++i) {
         
-        vector<string> files = listFiles(path[i], PLUGIN_SUFFIX);
+        const vector<string> &files = listings[i].files;
 
-        for (vector<string>::iterator fi = files.begin();
+        for (vector<string>::const_iterator fi = files.begin();
              fi != files.end(); ++fi) {
 
             // we match case-insensitively, but only with ascii range
@@ -152,14 +183,23 @@ Files::listLibraryFilesMatching(Filter filter)
 
 void *
 Files::loadLibrary(string path)
+{
+    string error;
+    void *handle = loadLibrary(path, error);
+    if (!handle) cerr << error << endl;
+    return handle;
+}
+
+void *
+Files::loadLibrary(string path, string &error)
 {
     void *handle = 0;
 #ifdef _WIN32
 #ifdef UNICODE
     int wlen = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), path.length(), 0, 0);
     if (wlen < 0) {
-        cerr << "Vamp::HostExt: Unable to convert library path \""
-             << path << "\" to wide characters " << endl;
+        error = "Vamp::HostExt: Unable to convert library path \""
+            + path + "\" to wide characters ";
         return handle;
     }
     wchar_t *buffer = new wchar_t[wlen+1];
@@ -171,14 +211,14 @@ Files::loadLibrary(string path)
     handle = LoadLibrary(path.c_str());
 #endif
     if (!handle) {
-        cerr << "Vamp::HostExt: Unable to load library \""
-             << path << "\"" << endl;
+        error = "Vamp::HostExt: Unable to load library \"" + path + "\"";
     }
 #else
     handle = dlopen(path.c_str(), RTLD_LAZY | RTLD_LOCAL);
     if (!handle) {
-        cerr << "Vamp::HostExt: Unable to load library \""
-             << path << "\": " << dlerror() << endl;
+        const char *e = dlerror();
+        error = "Vamp::HostExt: Unable to load library \"" + path + "\": "
+            + (e ? e : "");
     }
 #endif
     return handle;
@@ -322,3 +362,70 @@ Files::listFiles(string dir, string extension)
 
     return files;
 }
+
+bool
+Files::getStamp(string path, Stamp &stamp)
+{
+#ifdef _WIN32
+    struct _stat st;
+    if (_stat(path.c_str(), &st) != 0) return false;
+#else
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return false;
+#endif
+    stamp.mtime = long(st.st_mtime);
+    stamp.size = (unsigned long)st.st_size;
+    return true;
+}
+
+bool
+Files::makeDirectory(string dir)
+{
+#ifdef _WIN32
+    if (_mkdir(dir.c_str()) == 0) return true;
+#else
+    if (mkdir(dir.c_str(), 0755) == 0) return true;
+#endif
+    Stamp stamp;
+    return getStamp(dir, stamp); // already exists
+}
+
+bool
+Files::replaceFile(string from, string to)
+{
+#ifdef _WIN32
+    // rename will not overwrite an existing file on Windows
+    remove(to.c_str());
+#endif
+    return rename(from.c_str(), to.c_str()) == 0;
+}
+
+string
+Files::getCacheDirectory()
+{
+#ifdef _WIN32
+    char *cdir = getenv("LOCALAPPDATA");
+    if (cdir && cdir[0]) return cdir;
+    return "";
+#else
+    char *chome = getenv("HOME");
+#ifdef __APPLE__
+    if (chome && chome[0]) return string(chome) + "/Library/Caches";
+#else
+    char *cdir = getenv("XDG_CACHE_HOME");
+    if (cdir && cdir[0]) return cdir;
+    if (chome && chome[0]) return string(chome) + "/.cache";
+#endif
+    return "";
+#endif
+}
+
+int
+Files::getProcessId()
+{
+#ifdef _WIN32
+    return _getpid();
+#else
+    return int(getpid());
+#endif
+}
@@ -56,12 +56,38 @@ public:
     static std::vector<std::string> listLibraryFilesMatching(Filter);
 
     static void *loadLibrary(std::string filename);
+
+    /**
+     * As loadLibrary, but on failure return the message in error
+     * instead of printing it.
+     */
+    static void *loadLibrary(std::string filename, std::string &error);
     static void unloadLibrary(void *);
     static void *lookupInLibrary(void *, const char *symbol);
 
     static std::string lcBasename(std::string path);
     static std::string splicePath(std::string a, std::string b);
     static std::vector<std::string> listFiles(std::string dir, std::string ext);
+
+    /**
+     * Modification time and size of a file, used to tell whether a
+     * cached description of it is still current.
+     */
+    struct Stamp {
+        long mtime;
+        unsigned long size;
+        Stamp() : mtime(0), size(0) { }
+        bool operator==(const Stamp &s) const {
+            return mtime == s.mtime && size == s.size;
+        }
+        bool operator!=(const Stamp &s) const { return !operator==(s); }
+    };
+    static bool getStamp(std::string path, Stamp &stamp);
+
+    static bool makeDirectory(std::string dir);
+    static bool replaceFile(std::string from, std::string to);
+    static std::string getCacheDirectory();
+    static int getProcessId();
 };
 
 #endif
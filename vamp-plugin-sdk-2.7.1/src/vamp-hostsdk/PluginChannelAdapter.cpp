@@ -42,31 +42,40 @@ namespace Vamp {
 
 namespace HostExt {
 
-class PluginChannelAdapter::Impl
+class ChannelMixer::Impl
 {
 public:
-    Impl(Plugin *plugin);
+    Impl();
     ~Impl();
 
-    bool initialise(size_t channels, size_t stepSize, size_t blockSize);
+    size_t initialise(size_t inputChannels,
+                      size_t minChannels, size_t maxChannels,
+                      size_t blockSize);
 
-    FeatureSet process(const float *const *inputBuffers, RealTime timestamp);
-    FeatureSet processInterleaved(const float *inputBuffers, RealTime timestamp);
+    const float *const *mix(const float *const *inputBuffers);
+    const float *const *mixInterleaved(const float *inputBuffer);
 
 protected:
-    Plugin *m_plugin;
     size_t m_blockSize;
     size_t m_inputChannels;
     size_t m_pluginChannels;
     float **m_buffer;
     float **m_deinterleave;
     const float **m_forwardPtrs;
+
+    void clear();
+};
+
+// The adapter is the mixer with the plugin called after it
+
+class PluginChannelAdapter::Impl : public ChannelMixer
+{
 };
 
 PluginChannelAdapter::PluginChannelAdapter(Plugin *plugin) :
     PluginWrapper(plugin)
 {
-    m_impl = new Impl(plugin);
+    m_impl = new Impl;
 }
 
 PluginChannelAdapter::~PluginChannelAdapter()
@@ -77,25 +86,72 @@ PluginChannelAdapter::~PluginChannelAdapter()
 bool
 PluginChannelAdapter::initialise(size_t channels, size_t stepSize, size_t blockSize)
 {
-    return m_impl->initialise(channels, stepSize, blockSize);
+    size_t pluginChannels = m_impl->initialise
+        (channels, m_plugin->getMinChannelCount(),
+         m_plugin->getMaxChannelCount(), blockSize);
+
+    return m_plugin->initialise(pluginChannels, stepSize, blockSize);
 }
 
 PluginChannelAdapter::FeatureSet
 PluginChannelAdapter::process(const float *const *inputBuffers,
                               RealTime timestamp)
 {
-    return m_impl->process(inputBuffers, timestamp);
+    return m_plugin->process(m_impl->mix(inputBuffers), timestamp);
 }
 
 PluginChannelAdapter::FeatureSet
 PluginChannelAdapter::processInterleaved(const float *inputBuffers,
                                          RealTime timestamp)
 {
-    return m_impl->processInterleaved(inputBuffers, timestamp);
+    return m_plugin->process(m_impl->mixInterleaved(inputBuffers), timestamp);
+}
+
+bool
+PluginChannelAdapter::hasFlatFeatures() const
+{
+    return wrappedHasFlatFeatures();
 }
 
-PluginChannelAdapter::Impl::Impl(Plugin *plugin) :
-    m_plugin(plugin),
+const FlatFeatureSet &
+PluginChannelAdapter::processFlat(const float *const *inputBuffers,
+                                  RealTime timestamp)
+{
+    if (!hasFlatFeatures()) return m_noFeatures;
+    return getFlatSource()->processFlat(m_impl->mix(inputBuffers), timestamp);
+}
+
+ChannelMixer::ChannelMixer()
+{
+    m_impl = new Impl;
+}
+
+ChannelMixer::~ChannelMixer()
+{
+    delete m_impl;
+}
+
+size_t
+ChannelMixer::initialise(size_t inputChannels,
+                         size_t minChannels, size_t maxChannels,
+                         size_t blockSize)
+{
+    return m_impl->initialise(inputChannels, minChannels, maxChannels, blockSize);
+}
+
+const float *const *
+ChannelMixer::mix(const float *const *inputBuffers)
+{
+    return m_impl->mix(inputBuffers);
+}
+
+const float *const *
+ChannelMixer::mixInterleaved(const float *inputBuffer)
+{
+    return m_impl->mixInterleaved(inputBuffer);
+}
+
+ChannelMixer::Impl::Impl() :
     m_blockSize(0),
     m_inputChannels(0),
     m_pluginChannels(0),
@@ -105,10 +161,14 @@ PluginChannelAdapter::Impl::Impl(Plugin *plugin) :
 {
 }
 
-PluginChannelAdapter::Impl::~Impl()
+ChannelMixer::Impl::~Impl()
 {
-    // the adapter will delete the plugin
+    clear();
+}
 
+void
+ChannelMixer::Impl::clear()
+{
     if (m_buffer) {
         if (m_inputChannels > m_pluginChannels) {
             delete[] m_buffer[0];
@@ -135,14 +195,14 @@ PluginChannelAdapter::Impl::~Impl()
     }
 }
 
-bool
-PluginChannelAdapter::Impl::initialise(size_t channels, size_t stepSize, size_t blockSize)
+size_t
+ChannelMixer::Impl::initialise(size_t channels,
+                               size_t minch, size_t maxch,
+                               size_t blockSize)
 {
-    m_blockSize = blockSize;
-
-    size_t minch = m_plugin->getMinChannelCount();
-    size_t maxch = m_plugin->getMaxChannelCount();
+    clear();
 
+    m_blockSize = blockSize;
     m_inputChannels = channels;
 
     if (m_inputChannels < minch) {
@@ -153,7 +213,7 @@ PluginChannelAdapter::Impl::initialise(size_t channels, size_t stepSize, size_t
             // We need a set of zero-valued buffers to add to the
             // forwarded pointers
             m_buffer = new float*[minch - channels];
-            for (size_t i = 0; i < minch; ++i) {
+            for (size_t i = 0; i < minch - channels; ++i) {
                 m_buffer[i] = new float[blockSize];
                 for (size_t j = 0; j < blockSize; ++j) {
                     m_buffer[i][j] = 0.f;
@@ -163,7 +223,7 @@ PluginChannelAdapter::Impl::initialise(size_t channels, size_t stepSize, size_t
 
         m_pluginChannels = minch;
 
-//        std::cerr << "PluginChannelAdapter::initialise: expanding " << m_inputChannels << " to " << m_pluginChannels << " for plugin" << std::endl;
+//        std::cerr << "ChannelMixer::initialise: expanding " << m_inputChannels << " to " << m_pluginChannels << " for plugin" << std::endl;
 
     } else if (m_inputChannels > maxch) {
 
@@ -175,27 +235,26 @@ PluginChannelAdapter::Impl::initialise(size_t channels, size_t stepSize, size_t
             m_buffer = new float *[1];
             m_buffer[0] = new float[blockSize];
 
-//            std::cerr << "PluginChannelAdapter::initialise: mixing " << m_inputChannels << " to mono for plugin" << std::endl;
+//            std::cerr << "ChannelMixer::initialise: mixing " << m_inputChannels << " to mono for plugin" << std::endl;
 
         } else {
             
-//            std::cerr << "PluginChannelAdapter::initialise: reducing " << m_inputChannels << " to " << m_pluginChannels << " for plugin" << std::endl;
+//            std::cerr << "ChannelMixer::initialise: reducing " << m_inputChannels << " to " << m_pluginChannels << " for plugin" << std::endl;
         }
 
         m_pluginChannels = maxch;
 
     } else {
  
-//        std::cerr << "PluginChannelAdapter::initialise: accepting given number of channels (" << m_inputChannels << ")" << std::endl;
+//        std::cerr << "ChannelMixer::initialise: accepting given number of channels (" << m_inputChannels << ")" << std::endl;
         m_pluginChannels = m_inputChannels;
     }
 
-    return m_plugin->initialise(m_pluginChannels, stepSize, blockSize);
+    return m_pluginChannels;
 }
 
-PluginChannelAdapter::FeatureSet
-PluginChannelAdapter::Impl::processInterleaved(const float *inputBuffers,
-                                               RealTime timestamp)
+const float *const *
+ChannelMixer::Impl::mixInterleaved(const float *inputBuffers)
 {
     if (!m_deinterleave) {
         m_deinterleave = new float *[m_inputChannels];
@@ -210,14 +269,13 @@ PluginChannelAdapter::Impl::processInterleaved(const float *inputBuffers,
         }
     }
 
-    return process(m_deinterleave, timestamp);
+    return mix(m_deinterleave);
 }
 
-PluginChannelAdapter::FeatureSet
-PluginChannelAdapter::Impl::process(const float *const *inputBuffers,
-                                    RealTime timestamp)
+const float *const *
+ChannelMixer::Impl::mix(const float *const *inputBuffers)
 {
-//    std::cerr << "PluginChannelAdapter::process: " << m_inputChannels << " -> " << m_pluginChannels << " channels" << std::endl;
+//    std::cerr << "ChannelMixer::mix: " << m_inputChannels << " -> " << m_pluginChannels << " channels" << std::endl;
 
     if (m_inputChannels < m_pluginChannels) {
 
@@ -234,7 +292,7 @@ PluginChannelAdapter::Impl::process(const float *const *inputBuffers,
             }
         }
 
-        return m_plugin->process(m_forwardPtrs, timestamp);
+        return m_forwardPtrs;
 
     } else if (m_inputChannels > m_pluginChannels) {
 
@@ -250,14 +308,14 @@ PluginChannelAdapter::Impl::process(const float *const *inputBuffers,
             for (size_t j = 0; j < m_blockSize; ++j) {
                 m_buffer[0][j] /= float(m_inputChannels);
             }
-            return m_plugin->process(m_buffer, timestamp);
+            return m_buffer;
         } else {
-            return m_plugin->process(inputBuffers, timestamp);
+            return inputBuffers;
         }
 
     } else {
 
-        return m_plugin->process(inputBuffers, timestamp);
+        return inputBuffers;
     }
 }
 
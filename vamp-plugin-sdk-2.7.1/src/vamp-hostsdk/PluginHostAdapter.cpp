@@ -49,7 +49,11 @@ namespace Vamp
 PluginHostAdapter::PluginHostAdapter(const VampPluginDescriptor *descriptor,
                                      float inputSampleRate) :
     Plugin(inputSampleRate),
-    m_descriptor(descriptor)
+    m_descriptor(descriptor),
+    m_haveOutputs(false),
+    m_outputCount(0),
+    m_haveOutputCount(false),
+    m_heldFeatures(0)
 {
 //    std::cerr << "PluginHostAdapter::PluginHostAdapter (plugin = " << descriptor->name << ")" << std::endl;
     m_handle = m_descriptor->instantiate(m_descriptor, inputSampleRate);
@@ -61,6 +65,7 @@ PluginHostAdapter::PluginHostAdapter(const VampPluginDescriptor *descriptor,
 PluginHostAdapter::~PluginHostAdapter()
 {
 //    std::cerr << "PluginHostAdapter::~PluginHostAdapter (plugin = " << m_descriptor->name << ")" << std::endl;
+    releaseFlatFeatures();
     if (m_handle) m_descriptor->cleanup(m_handle);
 }
 
@@ -126,6 +131,8 @@ PluginHostAdapter::initialise(size_t channels,
                               size_t blockSize)
 {
     if (!m_handle) return false;
+    releaseFlatFeatures();
+    invalidateOutputs();
     return m_descriptor->initialise
         (m_handle,
          (unsigned int)channels,
@@ -142,6 +149,7 @@ PluginHostAdapter::reset()
         return;
     }
 //    std::cerr << "PluginHostAdapter::reset(" << m_handle << ")" << std::endl;
+    releaseFlatFeatures();
     m_descriptor->reset(m_handle);
 }
 
@@ -246,6 +254,7 @@ PluginHostAdapter::setParameter(std::string param,
     for (unsigned int i = 0; i < m_descriptor->parameterCount; ++i) {
         if (param == m_descriptor->parameters[i]->identifier) {
             m_descriptor->setParameter(m_handle, i, value);
+            invalidateOutputs();
             return;
         }
     }
@@ -284,6 +293,7 @@ PluginHostAdapter::selectProgram(std::string program)
     for (unsigned int i = 0; i < m_descriptor->programCount; ++i) {
         if (program == m_descriptor->programs[i]) {
             m_descriptor->selectProgram(m_handle, i);
+            invalidateOutputs();
             return;
         }
     }
@@ -320,13 +330,15 @@ PluginHostAdapter::getMaxChannelCount() const
 PluginHostAdapter::OutputList
 PluginHostAdapter::getOutputDescriptors() const
 {
+    if (m_haveOutputs) return m_outputs;
+
     OutputList list;
     if (!m_handle) {
 //        std::cerr << "PluginHostAdapter::getOutputDescriptors: no handle " << std::endl;
         return list;
     }
 
-    unsigned int count = m_descriptor->getOutputCount(m_handle);
+    unsigned int count = getOutputCount();
 
     for (unsigned int i = 0; i < count; ++i) {
         VampOutputDescriptor *sd = m_descriptor->getOutputDescriptor(m_handle, i);
@@ -370,9 +382,31 @@ PluginHostAdapter::getOutputDescriptors() const
         m_descriptor->releaseOutputDescriptor(sd);
     }
 
+    m_outputs = list;
+    m_haveOutputs = true;
     return list;
 }
 
+unsigned int
+PluginHostAdapter::getOutputCount() const
+{
+    if (!m_haveOutputCount) {
+        m_outputCount = m_descriptor->getOutputCount(m_handle);
+        m_haveOutputCount = true;
+    }
+    return m_outputCount;
+}
+
+void
+PluginHostAdapter::invalidateOutputs()
+{
+    // Parameters, programs and the block size may all change the
+    // number of outputs or their bin counts
+    m_outputs.clear();
+    m_haveOutputs = false;
+    m_haveOutputCount = false;
+}
+
 PluginHostAdapter::FeatureSet
 PluginHostAdapter::process(const float *const *inputBuffers,
                            RealTime timestamp)
@@ -380,6 +414,8 @@ PluginHostAdapter::process(const float *const *inputBuffers,
     FeatureSet fs;
     if (!m_handle) return fs;
 
+    releaseFlatFeatures();
+
     int sec = timestamp.sec;
     int nsec = timestamp.nsec;
     
@@ -397,6 +433,8 @@ PluginHostAdapter::getRemainingFeatures()
 {
     FeatureSet fs;
     if (!m_handle) return fs;
+
+    releaseFlatFeatures();
     
     VampFeatureList *features = m_descriptor->getRemainingFeatures(m_handle); 
 
@@ -405,13 +443,56 @@ PluginHostAdapter::getRemainingFeatures()
     return fs;
 }
 
+bool
+PluginHostAdapter::hasFlatFeatures() const
+{
+    return true;
+}
+
+const FlatFeatureSet &
+PluginHostAdapter::processFlat(const float *const *inputBuffers,
+                               RealTime timestamp)
+{
+    releaseFlatFeatures();
+    if (!m_handle) return m_flatFeatures;
+
+    m_heldFeatures = m_descriptor->process(m_handle,
+                                           inputBuffers,
+                                           timestamp.sec, timestamp.nsec);
+
+    convertFeatures(m_heldFeatures, m_flatFeatures);
+    return m_flatFeatures;
+}
+
+const FlatFeatureSet &
+PluginHostAdapter::getRemainingFeaturesFlat()
+{
+    releaseFlatFeatures();
+    if (!m_handle) return m_flatFeatures;
+
+    m_heldFeatures = m_descriptor->getRemainingFeatures(m_handle);
+
+    convertFeatures(m_heldFeatures, m_flatFeatures);
+    return m_flatFeatures;
+}
+
+void
+PluginHostAdapter::releaseFlatFeatures()
+{
+    m_flatFeatures.clear();
+    if (m_heldFeatures) {
+        m_descriptor->releaseFeatureSet(m_heldFeatures);
+        m_heldFeatures = 0;
+    }
+}
+
 void
 PluginHostAdapter::convertFeatures(VampFeatureList *features,
                                    FeatureSet &fs)
 {
     if (!features) return;
 
-    unsigned int outputs = m_descriptor->getOutputCount(m_handle);
+    unsigned int outputs = getOutputCount();
 
     for (unsigned int i = 0; i < outputs; ++i) {
         
@@ -458,6 +539,45 @@ PluginHostAdapter::convertFeatures(VampFeatureList *features,
     }
 }
 
+void
+PluginHostAdapter::convertFeatures(VampFeatureList *features,
+                                   FlatFeatureSet &fs)
+{
+    fs.clear();
+    if (!features) return;
+
+    unsigned int outputs = getOutputCount();
+    bool v2 = (m_descriptor->vampApiVersion >= 2);
+
+    for (unsigned int i = 0; i < outputs; ++i) {
+
+        fs.beginOutput();
+
+        const VampFeatureList &list = features[i];
+
+        for (unsigned int j = 0; j < list.featureCount; ++j) {
+
+            const VampFeature &v1 = list.features[j].v1;
+
+            FlatFeatureSet::Feature feature;
+            feature.hasTimestamp = v1.hasTimestamp;
+            feature.timestamp = RealTime(v1.sec, v1.nsec);
+            feature.hasDuration = false;
+            feature.valueCount = v1.valueCount;
+            feature.values = v1.values;
+            feature.label = v1.label;
+
+            if (v2) {
+                const VampFeatureV2 &f2 = list.features[j + list.featureCount].v2;
+                feature.hasDuration = f2.hasDuration;
+                feature.duration = RealTime(f2.durationSec, f2.durationNsec);
+            }
+
+            fs.addFeature(feature);
+        }
+    }
+}
+
 }
 
 _VAMP_SDK_HOSTSPACE_END(PluginHostAdapter.cpp)
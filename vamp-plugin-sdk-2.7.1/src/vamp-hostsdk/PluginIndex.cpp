@@ -0,0 +1,538 @@
+/* -*- c-basic-offset: 4 indent-tabs-mode: nil -*-  vi:set ts=8 sts=4 sw=4: */
+
+/*
+    Vamp
+
+    An API for audio analysis and feature extraction plugins.
+
+    Centre for Digital Music, Queen Mary, University of London.
+    Copyright 2006-2015 Chris Cannam and QMUL.
+  
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without
+    restriction, including without limitation the rights to use, copy,
+    modify, merge, publish, distribute, sublicense, and/or sell copies
+    of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR
+    ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+    CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+    Except as contained in this notice, the names of the Centre for
+    Digital Music; Queen Mary, University of London; and Chris Cannam
+    shall not be used in advertising or otherwise to promote the sale,
+    use or other dealings in this Software without prior written
+    authorization.
+*/
+
+#include "PluginIndex.h"
+
+#include <vamp/vamp.h>
+
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+_VAMP_SDK_HOSTSPACE_BEGIN(PluginIndex.cpp)
+
+namespace Vamp {
+
+namespace HostExt {
+
+// Bump this whenever the layout below changes; an index with a
+// different format number is ignored and rewritten.
+static const int indexFormat = 1;
+static const char *const indexMagic = "VampPluginIndex";
+
+// The index is a whitespace-separated token stream.  Strings are
+// written length-prefixed ("5:hello") so they need no escaping, and
+// floats as the hex of their bit pattern so they round-trip exactly.
+//
+// Lengths and counts read back are never trusted for allocation: a
+// corrupt one could be anything up to SIZE_MAX.  Strings and lists
+// grow only as their contents actually arrive, so a bad length runs
+// into the end of the file and fails the read, and the index is
+// rebuilt, instead of throwing bad_alloc.
+
+static void
+writeString(ostream &os, const string &s)
+{
+    os << s.length() << ':' << s << ' ';
+}
+
+static bool
+readString(istream &is, string &s)
+{
+    size_t len = 0;
+    char colon = 0;
+    if (!(is >> len) || !is.get(colon) || colon != ':') return false;
+    s.clear();
+    char buffer[1024];
+    while (len > 0) {
+        size_t chunk = (len < sizeof(buffer) ? len : sizeof(buffer));
+        if (!is.read(buffer, chunk)) return false;
+        s.append(buffer, chunk);
+        len -= chunk;
+    }
+    return true;
+}
+
+static void
+writeFloat(ostream &os, float f)
+{
+    unsigned int bits;
+    memcpy(&bits, &f, sizeof(bits));
+    os << hex << bits << dec << ' ';
+}
+
+static bool
+readFloat(istream &is, float &f)
+{
+    unsigned int bits;
+    if (!(is >> hex >> bits >> dec)) return false;
+    memcpy(&f, &bits, sizeof(f));
+    return true;
+}
+
+static void
+writeSize(ostream &os, size_t n)
+{
+    os << (unsigned long)n << ' ';
+}
+
+static bool
+readSize(istream &is, size_t &n)
+{
+    unsigned long u;
+    if (!(is >> u)) return false;
+    n = size_t(u);
+    return true;
+}
+
+static bool
+readBool(istream &is, bool &b)
+{
+    int i;
+    if (!(is >> i)) return false;
+    b = (i != 0);
+    return true;
+}
+
+static void
+writeStrings(ostream &os, const vector<string> &v)
+{
+    writeSize(os, v.size());
+    for (size_t i = 0; i < v.size(); ++i) writeString(os, v[i]);
+}
+
+static bool
+readStrings(istream &is, vector<string> &v)
+{
+    size_t n;
+    if (!readSize(is, n)) return false;
+    v.clear();
+    for (size_t i = 0; i < n; ++i) {
+        string s;
+        if (!readString(is, s)) return false;
+        v.push_back(s);
+    }
+    return true;
+}
+
+static void
+writeParameter(ostream &os, const Plugin::ParameterDescriptor &pd)
+{
+    writeString(os, pd.identifier);
+    writeString(os, pd.name);
+    writeString(os, pd.description);
+    writeString(os, pd.unit);
+    writeFloat(os, pd.minValue);
+    writeFloat(os, pd.maxValue);
+    writeFloat(os, pd.defaultValue);
+    os << int(pd.isQuantized) << ' ';
+    writeFloat(os, pd.quantizeStep);
+    writeStrings(os, pd.valueNames);
+}
+
+static bool
+readParameter(istream &is, Plugin::ParameterDescriptor &pd)
+{
+    return readString(is, pd.identifier) &&
+        readString(is, pd.name) &&
+        readString(is, pd.description) &&
+        readString(is, pd.unit) &&
+        readFloat(is, pd.minValue) &&
+        readFloat(is, pd.maxValue) &&
+        readFloat(is, pd.defaultValue) &&
+        readBool(is, pd.isQuantized) &&
+        readFloat(is, pd.quantizeStep) &&
+        readStrings(is, pd.valueNames);
+}
+
+static void
+writeOutput(ostream &os, const Plugin::OutputDescriptor &od)
+{
+    writeString(os, od.identifier);
+    writeString(os, od.name);
+    writeString(os, od.description);
+    writeString(os, od.unit);
+    os << int(od.hasFixedBinCount) << ' ';
+    writeSize(os, od.binCount);
+    writeStrings(os, od.binNames);
+    os << int(od.hasKnownExtents) << ' ';
+    writeFloat(os, od.minValue);
+    writeFloat(os, od.maxValue);
+    os << int(od.isQuantized) << ' ';
+    writeFloat(os, od.quantizeStep);
+    os << int(od.sampleType) << ' ';
+    writeFloat(os, od.sampleRate);
+    os << int(od.hasDuration) << ' ';
+}
+
+static bool
+readOutput(istream &is, Plugin::OutputDescriptor &od)
+{
+    int sampleType = 0;
+    bool ok = readString(is, od.identifier) &&
+        readString(is, od.name) &&
+        readString(is, od.description) &&
+        readString(is, od.unit) &&
+        readBool(is, od.hasFixedBinCount) &&
+        readSize(is, od.binCount) &&
+        readStrings(is, od.binNames) &&
+        readBool(is, od.hasKnownExtents) &&
+        readFloat(is, od.minValue) &&
+        readFloat(is, od.maxValue) &&
+        readBool(is, od.isQuantized) &&
+        readFloat(is, od.quantizeStep) &&
+        !!(is >> sampleType) &&
+        readFloat(is, od.sampleRate) &&
+        readBool(is, od.hasDuration);
+    if (!ok) return false;
+    switch (sampleType) {
+    case Plugin::OutputDescriptor::OneSamplePerStep:
+    case Plugin::OutputDescriptor::FixedSampleRate:
+    case Plugin::OutputDescriptor::VariableSampleRate:
+        od.sampleType = Plugin::OutputDescriptor::SampleType(sampleType);
+        return true;
+    default:
+        return false;
+    }
+}
+
+static void
+writePlugin(ostream &os, const PluginStaticData &d)
+{
+    writeString(os, d.pluginKey);
+    writeString(os, d.libraryPath);
+    os << d.apiVersion << ' ';
+    writeString(os, d.identifier);
+    writeString(os, d.name);
+    writeString(os, d.description);
+    writeString(os, d.maker);
+    writeString(os, d.copyright);
+    os << d.pluginVersion << ' ';
+    os << int(d.inputDomain) << ' ';
+    writeSize(os, d.preferredBlockSize);
+    writeSize(os, d.preferredStepSize);
+    writeSize(os, d.minChannelCount);
+    writeSize(os, d.maxChannelCount);
+    writeSize(os, d.parameters.size());
+    for (size_t i = 0; i < d.parameters.size(); ++i) {
+        writeParameter(os, d.parameters[i]);
+    }
+    writeStrings(os, d.programs);
+    writeFloat(os, d.referenceSampleRate);
+    writeSize(os, d.outputs.size());
+    for (size_t i = 0; i < d.outputs.size(); ++i) {
+        writeOutput(os, d.outputs[i]);
+    }
+    os << '\n';
+}
+
+static bool
+readPlugin(istream &is, PluginStaticData &d)
+{
+    int domain = 0;
+    size_t n = 0;
+    bool ok = readString(is, d.pluginKey) &&
+        readString(is, d.libraryPath) &&
+        !!(is >> d.apiVersion) &&
+        readString(is, d.identifier) &&
+        readString(is, d.name) &&
+        readString(is, d.description) &&
+        readString(is, d.maker) &&
+        readString(is, d.copyright) &&
+        !!(is >> d.pluginVersion) &&
+        !!(is >> domain) &&
+        readSize(is, d.preferredBlockSize) &&
+        readSize(is, d.preferredStepSize) &&
+        readSize(is, d.minChannelCount) &&
+        readSize(is, d.maxChannelCount) &&
+        readSize(is, n);
+    if (!ok) return false;
+    d.inputDomain = (domain == Plugin::FrequencyDomain ?
+                     Plugin::FrequencyDomain : Plugin::TimeDomain);
+    d.parameters.clear();
+    for (size_t i = 0; i < n; ++i) {
+        Plugin::ParameterDescriptor pd;
+        if (!readParameter(is, pd)) return false;
+        d.parameters.push_back(pd);
+    }
+    if (!readStrings(is, d.programs) ||
+        !readFloat(is, d.referenceSampleRate) ||
+        !readSize(is, n)) {
+        return false;
+    }
+    d.outputs.clear();
+    for (size_t i = 0; i < n; ++i) {
+        Plugin::OutputDescriptor od;
+        if (!readOutput(is, od)) return false;
+        d.outputs.push_back(od);
+    }
+    return true;
+}
+
+static void
+writeStamp(ostream &os, const Files::Stamp &stamp)
+{
+    os << stamp.mtime << ' ' << stamp.size << ' ';
+}
+
+static bool
+readStamp(istream &is, Files::Stamp &stamp)
+{
+    return !!(is >> stamp.mtime >> stamp.size);
+}
+
+PluginIndex::PluginIndex() :
+    m_path(getDefaultPath()),
+    m_loaded(false),
+    m_dirty(false)
+{
+}
+
+PluginIndex::~PluginIndex()
+{
+}
+
+string
+PluginIndex::getDefaultPath()
+{
+    char *cpath = getenv("VAMP_INDEX_PATH");
+    if (cpath) return cpath;
+
+    string dir = Files::getCacheDirectory();
+    if (dir == "") return "";
+    return Files::splicePath(dir, "vamp-plugin-index");
+}
+
+const PluginIndex::LibraryRecord *
+PluginIndex::getLibrary(string path, const Files::Stamp &stamp)
+{
+    load();
+    map<string, LibraryRecord>::const_iterator i = m_libraries.find(path);
+    if (i == m_libraries.end() || i->second.stamp != stamp) return 0;
+    return &i->second;
+}
+
+void
+PluginIndex::setLibrary(string path, const LibraryRecord &record)
+{
+    load();
+    m_libraries[path] = record;
+    m_dirty = true;
+}
+
+const PluginIndex::CatalogueRecord *
+PluginIndex::getCatalogue(string path, const Files::Stamp &stamp)
+{
+    load();
+    map<string, CatalogueRecord>::const_iterator i = m_catalogues.find(path);
+    if (i == m_catalogues.end() || i->second.stamp != stamp) return 0;
+    return &i->second;
+}
+
+void
+PluginIndex::setCatalogue(string path, const CatalogueRecord &record)
+{
+    load();
+    m_catalogues[path] = record;
+    m_dirty = true;
+}
+
+void
+PluginIndex::prune()
+{
+    load();
+
+    Files::Stamp stamp;
+    
+    map<string, LibraryRecord>::iterator li = m_libraries.begin();
+    while (li != m_libraries.end()) {
+        if (Files::getStamp(li->first, stamp)) {
+            ++li;
+        } else {
+            m_libraries.erase(li++);
+            m_dirty = true;
+        }
+    }
+
+    map<string, CatalogueRecord>::iterator ci = m_catalogues.begin();
+    while (ci != m_catalogues.end()) {
+        if (Files::getStamp(ci->first, stamp)) {
+            ++ci;
+        } else {
+            m_catalogues.erase(ci++);
+            m_dirty = true;
+        }
+    }
+}
+
+void
+PluginIndex::load()
+{
+    if (m_loaded) return;
+    m_loaded = true;
+
+    if (m_path == "") return;
+
+    ifstream is(m_path.c_str(), ifstream::in | ifstream::binary);
+    if (is.fail()) return;
+
+    string magic;
+    int format = 0, apiVersion = 0;
+    if (!(is >> magic >> format >> apiVersion) ||
+        magic != indexMagic ||
+        format != indexFormat ||
+        apiVersion != VAMP_API_VERSION) {
+        return;
+    }
+
+    string tag;
+    bool ok = true;
+
+    while (ok && (is >> tag)) {
+
+        string path;
+        size_t n = 0;
+
+        if (tag == "L") {
+            LibraryRecord record;
+            ok = readString(is, path) && readStamp(is, record.stamp) &&
+                readSize(is, n);
+            if (!ok) break;
+            for (size_t i = 0; ok && i < n; ++i) {
+                PluginStaticData d;
+                ok = readPlugin(is, d);
+                if (ok) record.plugins.push_back(d);
+            }
+            if (ok) m_libraries[path] = record;
+
+        } else if (tag == "C") {
+            CatalogueRecord record;
+            ok = readString(is, path) && readStamp(is, record.stamp) &&
+                readSize(is, n);
+            for (size_t i = 0; ok && i < n; ++i) {
+                string key;
+                ok = readString(is, key) &&
+                    readStrings(is, record.categories[key]);
+            }
+            if (ok) m_catalogues[path] = record;
+
+        } else {
+            ok = false;
+        }
+    }
+
+    if (!ok) {
+        // A truncated or corrupt index is simply rebuilt
+        m_libraries.clear();
+        m_catalogues.clear();
+        m_dirty = true;
+    }
+}
+
+void
+PluginIndex::save()
+{
+    if (!m_dirty || m_path == "") return;
+
+    string::size_type si = m_path.find_last_of("/\\");
+    if (si != string::npos && si > 0) {
+        Files::makeDirectory(m_path.substr(0, si));
+    }
+
+    // Write to a private temporary file and move it into place, so
+    // that a concurrent reader never sees a partial index
+    ostringstream tmpname;
+    tmpname << m_path << ".tmp" << Files::getProcessId();
+    string tmp = tmpname.str();
+
+    {
+        ofstream os(tmp.c_str(), ofstream::out | ofstream::binary);
+        if (os.fail()) return;
+
+        os << indexMagic << ' ' << indexFormat << ' '
+           << VAMP_API_VERSION << '\n';
+
+        for (map<string, LibraryRecord>::const_iterator i =
+                 m_libraries.begin(); i != m_libraries.end(); ++i) {
+            os << "L ";
+            writeString(os, i->first);
+            writeStamp(os, i->second.stamp);
+            writeSize(os, i->second.plugins.size());
+            os << '\n';
+            for (size_t j = 0; j < i->second.plugins.size(); ++j) {
+                writePlugin(os, i->second.plugins[j]);
+            }
+        }
+
+        for (map<string, CatalogueRecord>::const_iterator i =
+                 m_catalogues.begin(); i != m_catalogues.end(); ++i) {
+            os << "C ";
+            writeString(os, i->first);
+            writeStamp(os, i->second.stamp);
+            writeSize(os, i->second.categories.size());
+            os << '\n';
+            for (CategoryMap::const_iterator j =
+                     i->second.categories.begin();
+                 j != i->second.categories.end(); ++j) {
+                writeString(os, j->first);
+                writeStrings(os, j->second);
+                os << '\n';
+            }
+        }
+
+        os.flush();
+        if (os.fail()) {
+            os.close();
+            remove(tmp.c_str());
+            return;
+        }
+    }
+
+    if (Files::replaceFile(tmp, m_path)) {
+        m_dirty = false;
+    } else {
+        remove(tmp.c_str());
+    }
+}
+
+}
+
+}
+
+_VAMP_SDK_HOSTSPACE_END(PluginIndex.cpp)
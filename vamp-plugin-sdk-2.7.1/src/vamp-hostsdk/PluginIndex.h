@@ -0,0 +1,130 @@
+/* -*- c-basic-offset: 4 indent-tabs-mode: nil -*-  vi:set ts=8 sts=4 sw=4: */
+
+/*
+    Vamp
+
+    An API for audio analysis and feature extraction plugins.
+
+    Centre for Digital Music, Queen Mary, University of London.
+    Copyright 2006-2015 Chris Cannam and QMUL.
+  
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without
+    restriction, including without limitation the rights to use, copy,
+    modify, merge, publish, distribute, sublicense, and/or sell copies
+    of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR
+    ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+    CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+    Except as contained in this notice, the names of the Centre for
+    Digital Music; Queen Mary, University of London; and Chris Cannam
+    shall not be used in advertising or otherwise to promote the sale,
+    use or other dealings in this Software without prior written
+    authorization.
+*/
+
+#ifndef _VAMP_PLUGIN_INDEX_H_
+#define _VAMP_PLUGIN_INDEX_H_
+
+#include <vamp-hostsdk/PluginStaticData.h>
+
+#include "Files.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+_VAMP_SDK_HOSTSPACE_BEGIN(PluginIndex.h)
+
+namespace Vamp {
+
+namespace HostExt {
+
+/**
+ * This is a private implementation class for the Vamp Host SDK.
+ *
+ * PluginIndex is the on-disk cache behind PluginLoader.  It records,
+ * for each plugin library that has been probed, the static data of
+ * every plugin in it; and for each category (.cat) file that has
+ * been read, the categories it assigns.  Each record carries the
+ * modification time and size of its file and is only returned while
+ * those still match, so a changed or replaced library is probed
+ * again.
+ *
+ * The index lives in getDefaultPath(), which can be overridden with
+ * the VAMP_INDEX_PATH environment variable.  Setting VAMP_INDEX_PATH
+ * to an empty string disables the on-disk file, leaving only the
+ * in-memory cache.
+ */
+class PluginIndex
+{
+public:
+    PluginIndex();
+    ~PluginIndex();
+
+    static std::string getDefaultPath();
+
+    struct LibraryRecord {
+        Files::Stamp stamp;
+        std::vector<PluginStaticData> plugins;
+    };
+
+    typedef std::map<std::string, std::vector<std::string> > CategoryMap;
+
+    struct CatalogueRecord {
+        Files::Stamp stamp;
+        CategoryMap categories; // plugin key -> category hierarchy
+    };
+
+    /**
+     * Return the record for the given library if it is present and
+     * was made from a file with the given stamp, otherwise 0.
+     */
+    const LibraryRecord *getLibrary(std::string path,
+                                    const Files::Stamp &stamp);
+    void setLibrary(std::string path, const LibraryRecord &record);
+
+    const CatalogueRecord *getCatalogue(std::string path,
+                                        const Files::Stamp &stamp);
+    void setCatalogue(std::string path, const CatalogueRecord &record);
+
+    /**
+     * Drop records for files that no longer exist.
+     */
+    void prune();
+
+    /**
+     * Write the index back to disk, if anything has changed since
+     * it was read.
+     */
+    void save();
+
+protected:
+    std::string m_path;
+    bool m_loaded;
+    bool m_dirty;
+
+    std::map<std::string, LibraryRecord> m_libraries;
+    std::map<std::string, CatalogueRecord> m_catalogues;
+
+    void load();
+};
+
+}
+
+}
+
+_VAMP_SDK_HOSTSPACE_END(PluginIndex.h)
+
+#endif
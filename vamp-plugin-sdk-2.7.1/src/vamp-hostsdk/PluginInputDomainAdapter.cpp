@@ -57,9 +57,12 @@ namespace Vamp {
 
 namespace HostExt {
 
-class PluginInputDomainAdapter::Impl
+class InputDomainConverter::Impl
 {
 public:
+    typedef PluginInputDomainAdapter::ProcessTimestampMethod ProcessTimestampMethod;
+    typedef PluginInputDomainAdapter::WindowType WindowType;
+
     Impl(Plugin *plugin, float inputSampleRate);
     ~Impl();
     
@@ -69,7 +72,7 @@ public:
     size_t getPreferredStepSize() const;
     size_t getPreferredBlockSize() const;
 
-    FeatureSet process(const float *const *inputBuffers, RealTime timestamp);
+    const float *const *convert(const float *const *inputBuffers, RealTime &timestamp);
 
     void setProcessTimestampMethod(ProcessTimestampMethod m);
     ProcessTimestampMethod getProcessTimestampMethod() const;
@@ -81,6 +84,7 @@ public:
 
 protected:
     Plugin *m_plugin;
+    Plugin::InputDomain m_inputDomain;
     float m_inputSampleRate;
     int m_channels;
     int m_stepSize;
@@ -99,14 +103,23 @@ protected:
     Kiss::kiss_fftr_cfg m_cfg;
     Kiss::kiss_fft_cpx *m_cbuf;
 
-    FeatureSet processShiftingTimestamp(const float *const *inputBuffers, RealTime timestamp);
-    FeatureSet processShiftingData(const float *const *inputBuffers, RealTime timestamp);
+    const float *const *convertShiftingTimestamp(const float *const *inputBuffers, RealTime &timestamp);
+    const float *const *convertShiftingData(const float *const *inputBuffers);
 
     size_t makeBlockSizeAcceptable(size_t) const;
     
     W::WindowType convertType(WindowType t) const;
 };
 
+// The adapter is the converter with the plugin called after it
+
+class PluginInputDomainAdapter::Impl : public InputDomainConverter
+{
+public:
+    Impl(Plugin *plugin, float inputSampleRate) :
+        InputDomainConverter(plugin, inputSampleRate) { }
+};
+
 PluginInputDomainAdapter::PluginInputDomainAdapter(Plugin *plugin) :
     PluginWrapper(plugin)
 {
@@ -121,13 +134,15 @@ PluginInputDomainAdapter::~PluginInputDomainAdapter()
 bool
 PluginInputDomainAdapter::initialise(size_t channels, size_t stepSize, size_t blockSize)
 {
-    return m_impl->initialise(channels, stepSize, blockSize);
+    if (!m_impl->initialise(channels, stepSize, blockSize)) return false;
+    return m_plugin->initialise(channels, stepSize, blockSize);
 }
 
 void
 PluginInputDomainAdapter::reset()
 {
     m_impl->reset();
+    m_plugin->reset();
 }
 
 Plugin::InputDomain
@@ -151,7 +166,22 @@ PluginInputDomainAdapter::getPreferredBlockSize() const
 Plugin::FeatureSet
 PluginInputDomainAdapter::process(const float *const *inputBuffers, RealTime timestamp)
 {
-    return m_impl->process(inputBuffers, timestamp);
+    const float *const *buffers = m_impl->convert(inputBuffers, timestamp);
+    return m_plugin->process(buffers, timestamp);
+}
+
+bool
+PluginInputDomainAdapter::hasFlatFeatures() const
+{
+    return wrappedHasFlatFeatures();
+}
+
+const FlatFeatureSet &
+PluginInputDomainAdapter::processFlat(const float *const *inputBuffers, RealTime timestamp)
+{
+    if (!hasFlatFeatures()) return m_noFeatures;
+    const float *const *buffers = m_impl->convert(inputBuffers, timestamp);
+    return getFlatSource()->processFlat(buffers, timestamp);
 }
 
 void
@@ -184,18 +214,88 @@ PluginInputDomainAdapter::setWindowType(WindowType w)
     m_impl->setWindowType(w);
 }
 
+InputDomainConverter::InputDomainConverter(Plugin *plugin, float inputSampleRate)
+{
+    m_impl = new Impl(plugin, inputSampleRate);
+}
+
+InputDomainConverter::~InputDomainConverter()
+{
+    delete m_impl;
+}
+
+bool
+InputDomainConverter::initialise(size_t channels, size_t stepSize, size_t blockSize)
+{
+    return m_impl->initialise(channels, stepSize, blockSize);
+}
+
+void
+InputDomainConverter::reset()
+{
+    m_impl->reset();
+}
+
+size_t
+InputDomainConverter::getPreferredStepSize() const
+{
+    return m_impl->getPreferredStepSize();
+}
+
+size_t
+InputDomainConverter::getPreferredBlockSize() const
+{
+    return m_impl->getPreferredBlockSize();
+}
+
+const float *const *
+InputDomainConverter::convert(const float *const *inputBuffers, RealTime &timestamp)
+{
+    return m_impl->convert(inputBuffers, timestamp);
+}
+
+void
+InputDomainConverter::setProcessTimestampMethod(PluginInputDomainAdapter::ProcessTimestampMethod m)
+{
+    m_impl->setProcessTimestampMethod(m);
+}
+
+PluginInputDomainAdapter::ProcessTimestampMethod
+InputDomainConverter::getProcessTimestampMethod() const
+{
+    return m_impl->getProcessTimestampMethod();
+}
+
+RealTime
+InputDomainConverter::getTimestampAdjustment() const
+{
+    return m_impl->getTimestampAdjustment();
+}
+
+PluginInputDomainAdapter::WindowType
+InputDomainConverter::getWindowType() const
+{
+    return m_impl->getWindowType();
+}
 
-PluginInputDomainAdapter::Impl::Impl(Plugin *plugin, float inputSampleRate) :
+void
+InputDomainConverter::setWindowType(PluginInputDomainAdapter::WindowType w)
+{
+    m_impl->setWindowType(w);
+}
+
+InputDomainConverter::Impl::Impl(Plugin *plugin, float inputSampleRate) :
     m_plugin(plugin),
+    m_inputDomain(plugin->getInputDomain()),
     m_inputSampleRate(inputSampleRate),
     m_channels(0),
     m_stepSize(0),
     m_blockSize(0),
     m_freqbuf(0),
     m_ri(0),
-    m_windowType(HanningWindow),
+    m_windowType(PluginInputDomainAdapter::HanningWindow),
     m_window(0),
-    m_method(ShiftTimestamp),
+    m_method(PluginInputDomainAdapter::ShiftTimestamp),
     m_processCount(0),
     m_shiftBuffers(0),
     m_cfg(0),
@@ -203,10 +303,8 @@ PluginInputDomainAdapter::Impl::Impl(Plugin *plugin, float inputSampleRate) :
 {
 }
 
-PluginInputDomainAdapter::Impl::~Impl()
+InputDomainConverter::Impl::~Impl()
 {
-    // the adapter will delete the plugin
-
     if (m_shiftBuffers) {
         for (int c = 0; c < m_channels; ++c) {
             delete[] m_shiftBuffers[c];
@@ -214,7 +312,7 @@ PluginInputDomainAdapter::Impl::~Impl()
         delete[] m_shiftBuffers;
     }
 
-    if (m_channels > 0) {
+    if (m_freqbuf) {
         for (int c = 0; c < m_channels; ++c) {
             delete[] m_freqbuf[c];
         }
@@ -236,15 +334,15 @@ PluginInputDomainAdapter::Impl::~Impl()
 #endif
     
 bool
-PluginInputDomainAdapter::Impl::initialise(size_t channels, size_t stepSize, size_t blockSize)
+InputDomainConverter::Impl::initialise(size_t channels, size_t stepSize, size_t blockSize)
 {
-    if (m_plugin->getInputDomain() == TimeDomain) {
+    if (m_inputDomain == Plugin::TimeDomain) {
 
         m_stepSize = int(stepSize);
         m_blockSize = int(blockSize);
         m_channels = int(channels);
 
-        return m_plugin->initialise(channels, stepSize, blockSize);
+        return true;
     }
 
     if (blockSize < 2) {
@@ -257,7 +355,7 @@ PluginInputDomainAdapter::Impl::initialise(size_t channels, size_t stepSize, siz
         return false;
     }
 
-    if (m_channels > 0) {
+    if (m_freqbuf) {
         for (int c = 0; c < m_channels; ++c) {
             delete[] m_freqbuf[c];
         }
@@ -289,22 +387,21 @@ PluginInputDomainAdapter::Impl::initialise(size_t channels, size_t stepSize, siz
 
     m_processCount = 0;
 
-    return m_plugin->initialise(channels, stepSize, m_blockSize);
+    return true;
 }
 
 void
-PluginInputDomainAdapter::Impl::reset()
+InputDomainConverter::Impl::reset()
 {
     m_processCount = 0;
-    m_plugin->reset();
 }
 
 size_t
-PluginInputDomainAdapter::Impl::getPreferredStepSize() const
+InputDomainConverter::Impl::getPreferredStepSize() const
 {
     size_t step = m_plugin->getPreferredStepSize();
 
-    if (step == 0 && (m_plugin->getInputDomain() == FrequencyDomain)) {
+    if (step == 0 && (m_inputDomain == Plugin::FrequencyDomain)) {
         step = getPreferredBlockSize() / 2;
     }
 
@@ -312,11 +409,11 @@ PluginInputDomainAdapter::Impl::getPreferredStepSize() const
 }
 
 size_t
-PluginInputDomainAdapter::Impl::getPreferredBlockSize() const
+InputDomainConverter::Impl::getPreferredBlockSize() const
 {
     size_t block = m_plugin->getPreferredBlockSize();
 
-    if (m_plugin->getInputDomain() == FrequencyDomain) {
+    if (m_inputDomain == Plugin::FrequencyDomain) {
         if (block == 0) {
             block = 1024;
         } else {
@@ -328,7 +425,7 @@ PluginInputDomainAdapter::Impl::getPreferredBlockSize() const
 }
 
 size_t
-PluginInputDomainAdapter::Impl::makeBlockSizeAcceptable(size_t blockSize) const
+InputDomainConverter::Impl::makeBlockSizeAcceptable(size_t blockSize) const
 {
     if (blockSize < 2) {
 
@@ -347,11 +444,12 @@ PluginInputDomainAdapter::Impl::makeBlockSizeAcceptable(size_t blockSize) const
 }
 
 RealTime
-PluginInputDomainAdapter::Impl::getTimestampAdjustment() const
+InputDomainConverter::Impl::getTimestampAdjustment() const
 {
-    if (m_plugin->getInputDomain() == TimeDomain) {
+    if (m_inputDomain == Plugin::TimeDomain) {
         return RealTime::zeroTime;
-    } else if (m_method == ShiftData || m_method == NoShift) {
+    } else if (m_method == PluginInputDomainAdapter::ShiftData ||
+               m_method == PluginInputDomainAdapter::NoShift) {
         return RealTime::zeroTime;
     } else {
         return RealTime::frame2RealTime
@@ -360,19 +458,19 @@ PluginInputDomainAdapter::Impl::getTimestampAdjustment() const
 }
 
 void
-PluginInputDomainAdapter::Impl::setProcessTimestampMethod(ProcessTimestampMethod m)
+InputDomainConverter::Impl::setProcessTimestampMethod(ProcessTimestampMethod m)
 {
     m_method = m;
 }
 
-PluginInputDomainAdapter::ProcessTimestampMethod
-PluginInputDomainAdapter::Impl::getProcessTimestampMethod() const
+InputDomainConverter::Impl::ProcessTimestampMethod
+InputDomainConverter::Impl::getProcessTimestampMethod() const
 {
     return m_method;
 }
 
 void
-PluginInputDomainAdapter::Impl::setWindowType(WindowType t)
+InputDomainConverter::Impl::setWindowType(WindowType t)
 {
     if (m_windowType == t) return;
     m_windowType = t;
@@ -382,60 +480,61 @@ PluginInputDomainAdapter::Impl::setWindowType(WindowType t)
     }
 }
 
-PluginInputDomainAdapter::WindowType
-PluginInputDomainAdapter::Impl::getWindowType() const
+InputDomainConverter::Impl::WindowType
+InputDomainConverter::Impl::getWindowType() const
 {
     return m_windowType;
 }
 
-PluginInputDomainAdapter::Impl::W::WindowType
-PluginInputDomainAdapter::Impl::convertType(WindowType t) const
+InputDomainConverter::Impl::W::WindowType
+InputDomainConverter::Impl::convertType(WindowType t) const
 {
     switch (t) {
-    case RectangularWindow:
+    case PluginInputDomainAdapter::RectangularWindow:
         return W::RectangularWindow;
-    case BartlettWindow:
+    case PluginInputDomainAdapter::BartlettWindow:
         return W::BartlettWindow;
-    case HammingWindow:
+    case PluginInputDomainAdapter::HammingWindow:
         return W::HammingWindow;
-    case HanningWindow:
+    case PluginInputDomainAdapter::HanningWindow:
         return W::HanningWindow;
-    case BlackmanWindow:
+    case PluginInputDomainAdapter::BlackmanWindow:
         return W::BlackmanWindow;
-    case NuttallWindow:
+    case PluginInputDomainAdapter::NuttallWindow:
         return W::NuttallWindow;
-    case BlackmanHarrisWindow:
+    case PluginInputDomainAdapter::BlackmanHarrisWindow:
         return W::BlackmanHarrisWindow;
     default:
 	return W::HanningWindow;
     }
 }
 
-Plugin::FeatureSet
-PluginInputDomainAdapter::Impl::process(const float *const *inputBuffers,
-                                        RealTime timestamp)
+const float *const *
+InputDomainConverter::Impl::convert(const float *const *inputBuffers,
+                                    RealTime &timestamp)
 {
-    if (m_plugin->getInputDomain() == TimeDomain) {
-        return m_plugin->process(inputBuffers, timestamp);
+    if (m_inputDomain == Plugin::TimeDomain) {
+        return inputBuffers;
     }
 
-    if (m_method == ShiftTimestamp || m_method == NoShift) {
-        return processShiftingTimestamp(inputBuffers, timestamp);
+    if (m_method == PluginInputDomainAdapter::ShiftTimestamp ||
+        m_method == PluginInputDomainAdapter::NoShift) {
+        return convertShiftingTimestamp(inputBuffers, timestamp);
     } else {
-        return processShiftingData(inputBuffers, timestamp);
+        return convertShiftingData(inputBuffers);
     }
 }
 
-Plugin::FeatureSet
-PluginInputDomainAdapter::Impl::processShiftingTimestamp(const float *const *inputBuffers,
-                                                         RealTime timestamp)
+const float *const *
+InputDomainConverter::Impl::convertShiftingTimestamp(const float *const *inputBuffers,
+                                                         RealTime &timestamp)
 {
     unsigned int roundedRate = 1;
     if (m_inputSampleRate > 0.f) {
         roundedRate = (unsigned int)round(m_inputSampleRate);
     }
     
-    if (m_method == ShiftTimestamp) {
+    if (m_method == PluginInputDomainAdapter::ShiftTimestamp) {
         // we may need to add one nsec if timestamp +
         // getTimestampAdjustment() rounds down
         timestamp = timestamp + getTimestampAdjustment();
@@ -465,12 +564,11 @@ PluginInputDomainAdapter::Impl::processShiftingTimestamp(const float *const *inp
         }
     }
 
-    return m_plugin->process(m_freqbuf, timestamp);
+    return m_freqbuf;
 }
 
-Plugin::FeatureSet
-PluginInputDomainAdapter::Impl::processShiftingData(const float *const *inputBuffers,
-                                                    RealTime timestamp)
+const float *const *
+InputDomainConverter::Impl::convertShiftingData(const float *const *inputBuffers)
 {
     if (m_processCount == 0) {
         if (!m_shiftBuffers) {
@@ -516,7 +614,7 @@ PluginInputDomainAdapter::Impl::processShiftingData(const float *const *inputBuf
 
     ++m_processCount;
 
-    return m_plugin->process(m_freqbuf, timestamp);
+    return m_freqbuf;
 }
 
 }
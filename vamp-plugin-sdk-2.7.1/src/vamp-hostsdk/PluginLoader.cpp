@@ -43,6 +43,8 @@
 #include <vamp/vamp.h>
 
 #include "Files.h"
+#include "PluginIndex.h"
+#include "Threads.h"
 
 #include <fstream>
 
@@ -74,6 +76,8 @@ public:
 
     string getLibraryPathForPlugin(PluginKey key);
 
+    PluginStaticData getPluginStaticData(PluginKey key);
+
     static void setInstanceToClean(PluginLoader *instance);
 
 protected:
@@ -81,6 +85,7 @@ protected:
     public:
         PluginDeletionNotifyAdapter(Plugin *plugin, Impl *loader);
         virtual ~PluginDeletionNotifyAdapter();
+        bool hasFlatFeatures() const { return wrappedHasFlatFeatures(); }
     protected:
         Impl *m_loader;
     };
@@ -111,8 +116,39 @@ protected:
     /// that were added to it
     vector<PluginKey> enumeratePlugins(Enumeration);
 
+    /// Sample rate at which plugins are instantiated when probing a
+    /// library for the index
+    static const float m_probeSampleRate;
+
+    PluginIndex m_index;
+
+    /// Return the index record for a library, probing the library
+    /// and updating the index if it is not indexed or has changed
+    /// since. Returns 0 if the library cannot be loaded.
+    const PluginIndex::LibraryRecord *getLibraryRecord(string fullPath,
+                                                       bool specific);
+
+    /// As getLibraryRecord, for several libraries at once, probing
+    /// any that need it concurrently. The returned records are in the
+    /// same order as the paths, with 0 for any that cannot be loaded.
+    vector<const PluginIndex::LibraryRecord *> getLibraryRecords
+    (const vector<string> &fullPaths, bool specific);
+
+    /// Load a library and describe the plugins in it. This touches
+    /// no loader state and prints nothing (any diagnostics are
+    /// returned in messages), so it may be called from any thread.
+    static bool probeLibrary(string fullPath, bool specific,
+                             PluginIndex::LibraryRecord &record,
+                             string &messages);
+
+    class ProbeTask;
+
+    static PluginKey makePluginKey(string libraryName, string identifier);
+
     map<PluginKey, PluginCategoryHierarchy> m_taxonomy;
     void generateTaxonomy();
+    bool readCategoryFile(string filepath,
+                          PluginIndex::CategoryMap &categories);
 
     map<Plugin *, void *> m_pluginLibraryHandleMap;
 
@@ -125,6 +161,9 @@ protected:
 PluginLoader *
 PluginLoader::m_instance = 0;
 
+const float
+PluginLoader::Impl::m_probeSampleRate = 48000.f;
+
 PluginLoader::Impl::InstanceCleaner
 PluginLoader::Impl::m_cleaner;
 
@@ -194,6 +233,12 @@ PluginLoader::getLibraryPathForPlugin(PluginKey key)
 {
     return m_impl->getLibraryPathForPlugin(key);
 }
+
+PluginStaticData
+PluginLoader::getPluginStaticData(PluginKey key)
+{
+    return m_impl->getPluginStaticData(key);
+}
  
 PluginLoader::Impl::Impl() :
     m_allPluginsEnumerated(false)
@@ -297,41 +342,28 @@ PluginLoader::Impl::enumeratePlugins(Enumeration enumeration)
     bool specific = (enumeration.type == Enumeration::SinglePlugin ||
                      enumeration.type == Enumeration::InLibraries);
 
+    vector<const PluginIndex::LibraryRecord *> records =
+        getLibraryRecords(fullPaths, specific);
+
     vector<PluginKey> added;
     
     for (size_t i = 0; i < fullPaths.size(); ++i) {
 
         string fullPath = fullPaths[i];
-        void *handle = Files::loadLibrary(fullPath);
-        if (!handle) continue;
-            
-        VampGetPluginDescriptorFunction fn =
-            (VampGetPluginDescriptorFunction)Files::lookupInLibrary
-            (handle, "vampGetPluginDescriptor");
-            
-        if (!fn) {
-            if (specific) {
-                cerr << "Vamp::HostExt::PluginLoader: "
-                    << "No vampGetPluginDescriptor function found in library \""
-                     << fullPath << "\"" << endl;
-            }
-            Files::unloadLibrary(handle);
-            continue;
-        }
-            
-        int index = 0;
-        const VampPluginDescriptor *descriptor = 0;
+        const PluginIndex::LibraryRecord *record = records[i];
+        if (!record) continue;
+
         bool found = false;
-            
-        while ((descriptor = fn(VAMP_API_VERSION, index))) {
-            ++index;
+
+        for (size_t j = 0; j < record->plugins.size(); ++j) {
+            const PluginStaticData &data = record->plugins[j];
             if (identifier != "") {
-                if (descriptor->identifier != identifier) {
+                if (data.identifier != identifier) {
                     continue;
                 }
             }
             found = true;
-            PluginKey key = composePluginKey(fullPath, descriptor->identifier);
+            PluginKey key = data.pluginKey;
             if (m_pluginLibraryNameMap.find(key) ==
                 m_pluginLibraryNameMap.end()) {
                 m_pluginLibraryNameMap[key] = fullPath;
@@ -344,10 +376,13 @@ PluginLoader::Impl::enumeratePlugins(Enumeration enumeration)
                  << identifier << "\" not found in library \""
                  << fullPath << "\"" << endl;
         }
-            
-        Files::unloadLibrary(handle);
     }
 
+    if (enumeration.type == Enumeration::All) {
+        m_index.prune();
+    }
+    m_index.save();
+
     if (enumeration.type == Enumeration::All) {
         m_allPluginsEnumerated = true;
     }
@@ -355,8 +390,135 @@ PluginLoader::Impl::enumeratePlugins(Enumeration enumeration)
     return added;
 }
 
+class PluginLoader::Impl::ProbeTask : public Threads::Task
+{
+public:
+    string fullPath;
+    bool specific;
+    PluginIndex::LibraryRecord record;
+    string messages;
+    bool ok;
+
+    void run() {
+        ok = probeLibrary(fullPath, specific, record, messages);
+    }
+};
+
+bool
+PluginLoader::Impl::probeLibrary(string fullPath, bool specific,
+                                 PluginIndex::LibraryRecord &record,
+                                 string &messages)
+{
+    string error;
+    void *handle = Files::loadLibrary(fullPath, error);
+    if (!handle) {
+        messages += error + "\n";
+        return false;
+    }
+            
+    VampGetPluginDescriptorFunction fn =
+        (VampGetPluginDescriptorFunction)Files::lookupInLibrary
+        (handle, "vampGetPluginDescriptor");
+
+    record.plugins.clear();
+
+    if (!fn) {
+        if (specific) {
+            messages += "Vamp::HostExt::PluginLoader: "
+                "No vampGetPluginDescriptor function found in library \""
+                + fullPath + "\"\n";
+        }
+    } else {
+        int index = 0;
+        const VampPluginDescriptor *descriptor = 0;
+        while ((descriptor = fn(VAMP_API_VERSION, index))) {
+            ++index;
+            PluginKey key = makePluginKey(fullPath, descriptor->identifier);
+            PluginHostAdapter plugin(descriptor, m_probeSampleRate);
+            PluginStaticData data = PluginStaticData::fromPlugin
+                (key, &plugin, m_probeSampleRate);
+            data.libraryPath = fullPath;
+            record.plugins.push_back(data);
+        }
+    }
+
+    Files::unloadLibrary(handle);
+    return true;
+}
+
+vector<const PluginIndex::LibraryRecord *>
+PluginLoader::Impl::getLibraryRecords(const vector<string> &fullPaths,
+                                      bool specific)
+{
+    vector<const PluginIndex::LibraryRecord *> records(fullPaths.size(), 0);
+    vector<ProbeTask> probes;
+    vector<size_t> probeIndices;
+
+    for (size_t i = 0; i < fullPaths.size(); ++i) {
+        Files::Stamp stamp;
+        if (!Files::getStamp(fullPaths[i], stamp)) continue;
+        records[i] = m_index.getLibrary(fullPaths[i], stamp);
+        if (records[i]) continue;
+        ProbeTask probe;
+        probe.fullPath = fullPaths[i];
+        probe.specific = specific;
+        probe.record.stamp = stamp;
+        probe.ok = false;
+        probes.push_back(probe);
+        probeIndices.push_back(i);
+    }
+
+    if (probes.empty()) return records;
+
+    vector<Threads::Task *> tasks;
+    for (size_t i = 0; i < probes.size(); ++i) {
+        tasks.push_back(&probes[i]);
+    }
+    Threads::runAll(tasks);
+
+    // Merge on this thread, in path order, so that the index contents
+    // and any diagnostics do not depend on which probe finished first
+    for (size_t i = 0; i < probes.size(); ++i) {
+        cerr << probes[i].messages;
+        if (probes[i].ok) {
+            m_index.setLibrary(probes[i].fullPath, probes[i].record);
+            records[probeIndices[i]] = m_index.getLibrary
+                (probes[i].fullPath, probes[i].record.stamp);
+        }
+    }
+
+    return records;
+}
+
+const PluginIndex::LibraryRecord *
+PluginLoader::Impl::getLibraryRecord(string fullPath, bool specific)
+{
+    Files::Stamp stamp;
+    if (!Files::getStamp(fullPath, stamp)) return 0;
+
+    const PluginIndex::LibraryRecord *record =
+        m_index.getLibrary(fullPath, stamp);
+    if (record) return record;
+
+    PluginIndex::LibraryRecord newRecord;
+    newRecord.stamp = stamp;
+    string messages;
+    bool ok = probeLibrary(fullPath, specific, newRecord, messages);
+    cerr << messages;
+    if (!ok) return 0;
+
+    m_index.setLibrary(fullPath, newRecord);
+    return m_index.getLibrary(fullPath, stamp);
+}
+
 PluginLoader::PluginKey
 PluginLoader::Impl::composePluginKey(string libraryName, string identifier)
+{
+    return makePluginKey(libraryName, identifier);
+}
+
+PluginLoader::PluginKey
+PluginLoader::Impl::makePluginKey(string libraryName, string identifier)
 {
     string basename = Files::lcBasename(libraryName);
     return basename + ":" + identifier;
@@ -403,6 +565,33 @@ PluginLoader::Impl::getLibraryPathForPlugin(PluginKey plugin)
     return m_pluginLibraryNameMap[plugin];
 }    
 
+PluginStaticData
+PluginLoader::Impl::getPluginStaticData(PluginKey plugin)
+{
+    string libname, identifier;
+    if (!decomposePluginKey(plugin, libname, identifier)) {
+        return PluginStaticData();
+    }
+
+    string fullPath = getLibraryPathForPlugin(plugin);
+    if (fullPath == "") return PluginStaticData();
+
+    const PluginIndex::LibraryRecord *record =
+        getLibraryRecord(fullPath, true);
+    if (!record) return PluginStaticData();
+
+    for (size_t i = 0; i < record->plugins.size(); ++i) {
+        if (record->plugins[i].identifier == identifier) {
+            PluginStaticData data = record->plugins[i];
+            data.category = getPluginCategory(plugin);
+            m_index.save();
+            return data;
+        }
+    }
+
+    return PluginStaticData();
+}
+
 Plugin *
 PluginLoader::Impl::loadPlugin(PluginKey key,
                                float inputSampleRate, int adapterFlags)
@@ -507,8 +696,6 @@ PluginLoader::Impl::generateTaxonomy()
         catpath.push_back(dir);
     }
 
-    char buffer[1024];
-
     for (vector<string>::iterator i = catpath.begin();
          i != catpath.end(); ++i) {
         
@@ -518,50 +705,84 @@ PluginLoader::Impl::generateTaxonomy()
              fi != files.end(); ++fi) {
 
             string filepath = Files::splicePath(*i, *fi);
-            ifstream is(filepath.c_str(), ifstream::in | ifstream::binary);
 
-            if (is.fail()) {
-//                cerr << "failed to open: " << filepath << endl;
-                continue;
+            Files::Stamp stamp;
+            if (!Files::getStamp(filepath, stamp)) continue;
+
+            const PluginIndex::CatalogueRecord *record =
+                m_index.getCatalogue(filepath, stamp);
+
+            if (!record) {
+                PluginIndex::CatalogueRecord newRecord;
+                newRecord.stamp = stamp;
+                if (!readCategoryFile(filepath, newRecord.categories)) {
+                    continue;
+                }
+                m_index.setCatalogue(filepath, newRecord);
+                record = m_index.getCatalogue(filepath, stamp);
+            }
+
+            for (PluginIndex::CategoryMap::const_iterator ci =
+                     record->categories.begin();
+                 ci != record->categories.end(); ++ci) {
+                m_taxonomy[ci->first] = ci->second;
             }
+        }
+    }
+
+    m_index.save();
+}    
+
+bool
+PluginLoader::Impl::readCategoryFile(string filepath,
+                                     PluginIndex::CategoryMap &categories)
+{
+    ifstream is(filepath.c_str(), ifstream::in | ifstream::binary);
 
-//            cerr << "opened: " << filepath << endl;
+    if (is.fail()) {
+//        cerr << "failed to open: " << filepath << endl;
+        return false;
+    }
 
-            while (!!is.getline(buffer, 1024)) {
+//    cerr << "opened: " << filepath << endl;
 
-                string line(buffer);
+    char buffer[1024];
 
-//                cerr << "line = " << line << endl;
+    while (!!is.getline(buffer, 1024)) {
 
-                string::size_type di = line.find("::");
-                if (di == string::npos) continue;
+        string line(buffer);
 
-                string id = line.substr(0, di);
-                string encodedCat = line.substr(di + 2);
+//        cerr << "line = " << line << endl;
 
-                if (id.substr(0, 5) != "vamp:") continue;
-                id = id.substr(5);
+        string::size_type di = line.find("::");
+        if (di == string::npos) continue;
 
-                while (encodedCat.length() >= 1 &&
-                       encodedCat[encodedCat.length()-1] == '\r') {
-                    encodedCat = encodedCat.substr(0, encodedCat.length()-1);
-                }
+        string id = line.substr(0, di);
+        string encodedCat = line.substr(di + 2);
 
-//                cerr << "id = " << id << ", cat = " << encodedCat << endl;
+        if (id.substr(0, 5) != "vamp:") continue;
+        id = id.substr(5);
 
-                PluginCategoryHierarchy category;
-                string::size_type ai;
-                while ((ai = encodedCat.find(" > ")) != string::npos) {
-                    category.push_back(encodedCat.substr(0, ai));
-                    encodedCat = encodedCat.substr(ai + 3);
-                }
-                if (encodedCat != "") category.push_back(encodedCat);
+        while (encodedCat.length() >= 1 &&
+               encodedCat[encodedCat.length()-1] == '\r') {
+            encodedCat = encodedCat.substr(0, encodedCat.length()-1);
+        }
 
-                m_taxonomy[id] = category;
-            }
+//        cerr << "id = " << id << ", cat = " << encodedCat << endl;
+
+        PluginCategoryHierarchy category;
+        string::size_type ai;
+        while ((ai = encodedCat.find(" > ")) != string::npos) {
+            category.push_back(encodedCat.substr(0, ai));
+            encodedCat = encodedCat.substr(ai + 3);
         }
+        if (encodedCat != "") category.push_back(encodedCat);
+
+        categories[id] = category;
     }
-}    
+
+    return true;
+}
 
 void
 PluginLoader::Impl::pluginDeleted(PluginDeletionNotifyAdapter *adapter)
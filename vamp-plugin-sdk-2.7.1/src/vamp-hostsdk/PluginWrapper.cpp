@@ -197,6 +197,40 @@ PluginWrapper::getRemainingFeatures()
     return m_plugin->getRemainingFeatures();
 }
 
+bool
+PluginWrapper::hasFlatFeatures() const
+{
+    return false;
+}
+
+const FlatFeatureSet &
+PluginWrapper::processFlat(const float *const *inputBuffers, RealTime timestamp)
+{
+    if (!hasFlatFeatures()) return m_noFeatures;
+    return getFlatSource()->processFlat(inputBuffers, timestamp);
+}
+
+const FlatFeatureSet &
+PluginWrapper::getRemainingFeaturesFlat()
+{
+    if (!hasFlatFeatures()) return m_noFeatures;
+    return getFlatSource()->getRemainingFeaturesFlat();
+}
+
+FlatFeatureSource *
+PluginWrapper::getFlatSource() const
+{
+    FlatFeatureSource *source = dynamic_cast<FlatFeatureSource *>(m_plugin);
+    if (source && source->hasFlatFeatures()) return source;
+    return 0;
+}
+
+bool
+PluginWrapper::wrappedHasFlatFeatures() const
+{
+    return getFlatSource() != 0;
+}
+
 }
 
 }
@@ -0,0 +1,175 @@
+/* -*- c-basic-offset: 4 indent-tabs-mode: nil -*-  vi:set ts=8 sts=4 sw=4: */
+
+/*
+    Vamp
+
+    An API for audio analysis and feature extraction plugins.
+
+    Centre for Digital Music, Queen Mary, University of London.
+    Copyright 2006-2015 Chris Cannam and QMUL.
+  
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without
+    restriction, including without limitation the rights to use, copy,
+    modify, merge, publish, distribute, sublicense, and/or sell copies
+    of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR
+    ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+    CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+    Except as contained in this notice, the names of the Centre for
+    Digital Music; Queen Mary, University of London; and Chris Cannam
+    shall not be used in advertising or otherwise to promote the sale,
+    use or other dealings in this Software without prior written
+    authorization.
+*/
+
+#include "Threads.h"
+
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+class Mutex
+{
+public:
+#ifdef _WIN32
+    Mutex() { InitializeCriticalSection(&m_cs); }
+    ~Mutex() { DeleteCriticalSection(&m_cs); }
+    void lock() { EnterCriticalSection(&m_cs); }
+    void unlock() { LeaveCriticalSection(&m_cs); }
+private:
+    CRITICAL_SECTION m_cs;
+#else
+    Mutex() { pthread_mutex_init(&m_mutex, 0); }
+    ~Mutex() { pthread_mutex_destroy(&m_mutex); }
+    void lock() { pthread_mutex_lock(&m_mutex); }
+    void unlock() { pthread_mutex_unlock(&m_mutex); }
+private:
+    pthread_mutex_t m_mutex;
+#endif
+};
+
+// Shared between the workers of a single runAll call: each worker
+// repeatedly takes the next unstarted task until none remain
+struct Queue
+{
+    const vector<Threads::Task *> *tasks;
+    size_t next;
+    Mutex mutex;
+
+    Threads::Task *take() {
+        Threads::Task *task = 0;
+        mutex.lock();
+        if (next < tasks->size()) task = (*tasks)[next++];
+        mutex.unlock();
+        return task;
+    }
+
+    void drain() {
+        Threads::Task *task;
+        while ((task = take())) task->run();
+    }
+};
+
+#ifdef _WIN32
+unsigned __stdcall
+worker(void *arg)
+{
+    static_cast<Queue *>(arg)->drain();
+    return 0;
+}
+#else
+extern "C" void *
+worker(void *arg)
+{
+    static_cast<Queue *>(arg)->drain();
+    return 0;
+}
+#endif
+
+}
+
+void
+Threads::runAll(const vector<Task *> &tasks)
+{
+    Queue queue;
+    queue.tasks = &tasks;
+    queue.next = 0;
+
+    int count = getScanThreadCount();
+    if (count > int(tasks.size())) count = int(tasks.size());
+
+    // The calling thread is one of the workers, so start count-1
+    // more. If a thread can't be started, the others just take on
+    // more of the tasks.
+
+#ifdef _WIN32
+    vector<HANDLE> threads;
+    for (int i = 1; i < count; ++i) {
+        uintptr_t t = _beginthreadex(0, 0, worker, &queue, 0, 0);
+        if (t) threads.push_back((HANDLE)t);
+    }
+#else
+    vector<pthread_t> threads;
+    for (int i = 1; i < count; ++i) {
+        pthread_t t;
+        if (pthread_create(&t, 0, worker, &queue) == 0) {
+            threads.push_back(t);
+        }
+    }
+#endif
+
+    queue.drain();
+
+    for (size_t i = 0; i < threads.size(); ++i) {
+#ifdef _WIN32
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], 0);
+#endif
+    }
+}
+
+int
+Threads::getScanThreadCount()
+{
+    char *cthreads = getenv("VAMP_SCAN_THREADS");
+    if (cthreads) {
+        int n = atoi(cthreads);
+        if (n > 0) return n;
+    }
+
+    int n = 1;
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    n = int(info.dwNumberOfProcessors);
+#else
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    if (online > 0) n = int(online);
+#endif
+    if (n < 4) n = 4;
+    return n;
+}
@@ -0,0 +1,79 @@
+/* -*- c-basic-offset: 4 indent-tabs-mode: nil -*-  vi:set ts=8 sts=4 sw=4: */
+
+/*
+    Vamp
+
+    An API for audio analysis and feature extraction plugins.
+
+    Centre for Digital Music, Queen Mary, University of London.
+    Copyright 2006-2015 Chris Cannam and QMUL.
+  
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without
+    restriction, including without limitation the rights to use, copy,
+    modify, merge, publish, distribute, sublicense, and/or sell copies
+    of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR
+    ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+    CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+    Except as contained in this notice, the names of the Centre for
+    Digital Music; Queen Mary, University of London; and Chris Cannam
+    shall not be used in advertising or otherwise to promote the sale,
+    use or other dealings in this Software without prior written
+    authorization.
+*/
+
+#ifndef VAMP_THREADS_H
+#define VAMP_THREADS_H
+
+#include <vector>
+
+/**
+ * This is a private implementation class for the Vamp Host SDK.
+ *
+ * Threads runs a batch of independent tasks on a small set of worker
+ * threads and returns when all of them have finished.  It is used to
+ * overlap slow filesystem and dynamic-loader calls when scanning the
+ * plugin path.  Tasks must not touch shared state without their own
+ * locking; the usual pattern is for each task to write only into its
+ * own result slot, and for the caller to merge the results in order
+ * afterwards.
+ */
+class Threads
+{
+public:
+    class Task {
+    public:
+        virtual ~Task() { }
+        virtual void run() = 0;
+    };
+
+    /**
+     * Run all of the given tasks, using at most getScanThreadCount()
+     * threads (including the calling thread), and return when all
+     * are complete.  The tasks are not deleted.
+     */
+    static void runAll(const std::vector<Task *> &tasks);
+
+    /**
+     * Number of threads to use for plugin path scanning.  This is
+     * the VAMP_SCAN_THREADS environment variable if set, otherwise
+     * the number of online processors with a minimum of four, since
+     * the work is mostly waiting on I/O.  Setting VAMP_SCAN_THREADS
+     * to 1 makes scanning serial.
+     */
+    static int getScanThreadCount();
+};
+
+#endif
@@ -41,9 +41,73 @@
 
 #include <cmath>
 #include <cstdlib>
+#include <map>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define _VAMP_WINDOW_SSE2 1
+#endif
 
 _VAMP_SDK_HOSTSPACE_BEGIN(Window.h)
 
+/**
+ * Element-wise dst[i] = src[i] * win[i].  The generic version is a
+ * plain loop; the overloads below cover the type combinations used
+ * by PluginInputDomainAdapter and use SSE2 where it is available.
+ * src and dst may be the same buffer.
+ */
+template <typename S, typename W, typename D>
+inline void windowMultiply(const S *src, const W *win, D *dst, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) dst[i] = src[i] * win[i];
+}
+
+inline void windowMultiply(const float *src, const float *win, float *dst, size_t n)
+{
+    size_t i = 0;
+#ifdef _VAMP_WINDOW_SSE2
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(src + i),
+                                          _mm_loadu_ps(win + i)));
+    }
+#endif
+    for (; i < n; ++i) dst[i] = src[i] * win[i];
+}
+
+inline void windowMultiply(const double *src, const double *win, double *dst, size_t n)
+{
+    size_t i = 0;
+#ifdef _VAMP_WINDOW_SSE2
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(dst + i, _mm_mul_pd(_mm_loadu_pd(src + i),
+                                          _mm_loadu_pd(win + i)));
+    }
+#endif
+    for (; i < n; ++i) dst[i] = src[i] * win[i];
+}
+
+inline void windowMultiply(const float *src, const double *win, double *dst, size_t n)
+{
+    size_t i = 0;
+#ifdef _VAMP_WINDOW_SSE2
+    for (; i + 4 <= n; i += 4) {
+        __m128 s = _mm_loadu_ps(src + i);
+        __m128d lo = _mm_cvtps_pd(s);
+        __m128d hi = _mm_cvtps_pd(_mm_movehl_ps(s, s));
+        _mm_storeu_pd(dst + i, _mm_mul_pd(lo, _mm_loadu_pd(win + i)));
+        _mm_storeu_pd(dst + i + 2, _mm_mul_pd(hi, _mm_loadu_pd(win + i + 2)));
+    }
+#endif
+    for (; i < n; ++i) dst[i] = src[i] * win[i];
+}
+
 template <typename T>
 class Window
 {
@@ -60,25 +124,32 @@ public:
 
     /**
      * Construct a windower of the given type.
+     *
+     * Window tables are calculated once per (type, size) and shared
+     * read-only between all windows of the same sample type for the
+     * lifetime of the process, so constructing and copying windows
+     * is cheap after the first one.
      */
     Window(WindowType type, size_t size) : m_type(type), m_size(size) { encache(); }
-    Window(const Window &w) : m_type(w.m_type), m_size(w.m_size) { encache(); }
+    Window(const Window &w) :
+        m_type(w.m_type), m_size(w.m_size), m_cache(w.m_cache), m_area(w.m_area) { }
     Window &operator=(const Window &w) {
 	if (&w == this) return *this;
 	m_type = w.m_type;
 	m_size = w.m_size;
-	encache();
+	m_cache = w.m_cache;
+	m_area = w.m_area;
 	return *this;
     }
-    virtual ~Window() { delete[] m_cache; }
+    virtual ~Window() { } // m_cache belongs to the shared table cache
     
     void cut(T *src) const { cut(src, src); }
     void cut(T *src, T *dst) const {
-	for (size_t i = 0; i < m_size; ++i) dst[i] = src[i] * m_cache[i];
+        windowMultiply(src, m_cache, dst, m_size);
     }
     template <typename T0, typename T1>
     void cut(T0 *src, T1 *dst) const {
-	for (size_t i = 0; i < m_size; ++i) dst[i] = src[i] * m_cache[i];
+        windowMultiply(src, m_cache, dst, m_size);
     }
 
     T getArea() { return m_area; }
@@ -90,22 +161,69 @@ public:
 protected:
     WindowType m_type;
     size_t m_size;
-    T *m_cache;
+    const T *m_cache;
     T m_area;
     
     void encache();
-    void cosinewin(T *, T, T, T, T);
+    static T *calculate(WindowType type, size_t size);
+    static void cosinewin(T *, size_t, T, T, T, T);
+
+    struct Table {
+        const T *data;
+        T area;
+    };
+    typedef std::map<std::pair<int, size_t>, Table> TableMap;
 };
 
 template <typename T>
 void Window<T>::encache()
 {
-    int n = int(m_size);
+#ifdef _WIN32
+    static volatile LONG lock = 0;
+    while (InterlockedExchange(&lock, 1)) Sleep(0);
+#else
+    static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_mutex_lock(&mutex);
+#endif
+
+    static TableMap *tables = 0;
+    if (!tables) tables = new TableMap;
+
+    std::pair<int, size_t> key(int(m_type), m_size);
+    typename TableMap::iterator i = tables->find(key);
+
+    if (i == tables->end()) {
+        Table table;
+        T *mult = calculate(m_type, m_size);
+        int n = int(m_size);
+        table.data = mult;
+        table.area = 0;
+        for (int j = 0; j < n; ++j) {
+            table.area += mult[j];
+        }
+        table.area /= n;
+        i = tables->insert(typename TableMap::value_type(key, table)).first;
+    }
+
+    m_cache = i->second.data;
+    m_area = i->second.area;
+
+#ifdef _WIN32
+    InterlockedExchange(&lock, 0);
+#else
+    pthread_mutex_unlock(&mutex);
+#endif
+}
+
+template <typename T>
+T *Window<T>::calculate(WindowType type, size_t size)
+{
+    int n = int(size);
     T *mult = new T[n];
     int i;
     for (i = 0; i < n; ++i) mult[i] = 1.0;
 
-    switch (m_type) {
+    switch (type) {
 		
     case RectangularWindow:
 	for (i = 0; i < n; ++i) {
@@ -121,39 +239,33 @@ void Window<T>::encache()
 	break;
 	    
     case HammingWindow:
-        cosinewin(mult, 0.54, 0.46, 0.0, 0.0);
+        cosinewin(mult, size, 0.54, 0.46, 0.0, 0.0);
 	break;
 	    
     case HanningWindow:
-        cosinewin(mult, 0.50, 0.50, 0.0, 0.0);
+        cosinewin(mult, size, 0.50, 0.50, 0.0, 0.0);
 	break;
 	    
     case BlackmanWindow:
-        cosinewin(mult, 0.42, 0.50, 0.08, 0.0);
+        cosinewin(mult, size, 0.42, 0.50, 0.08, 0.0);
 	break;
 
     case NuttallWindow:
-        cosinewin(mult, 0.3635819, 0.4891775, 0.1365995, 0.0106411);
+        cosinewin(mult, size, 0.3635819, 0.4891775, 0.1365995, 0.0106411);
 	break;
 
     case BlackmanHarrisWindow:
-        cosinewin(mult, 0.35875, 0.48829, 0.14128, 0.01168);
+        cosinewin(mult, size, 0.35875, 0.48829, 0.14128, 0.01168);
         break;
     }
-	
-    m_cache = mult;
 
-    m_area = 0;
-    for (int i = 0; i < n; ++i) {
-        m_area += m_cache[i];
-    }
-    m_area /= n;
+    return mult;
 }
 
 template <typename T>
-void Window<T>::cosinewin(T *mult, T a0, T a1, T a2, T a3)
+void Window<T>::cosinewin(T *mult, size_t size, T a0, T a1, T a2, T a3)
 {
-    int n = int(m_size);
+    int n = int(size);
     for (int i = 0; i < n; ++i) {
         mult[i] *= (a0
                     - a1 * cos((2 * M_PI * i) / n)
@@ -43,13 +43,6 @@
 
 #include <iostream>
 
-#if (defined(__GNUC__)) && (__GNUC__ < 3)
-#include <strstream>
-#define stringstream strstream
-#else
-#include <sstream>
-#endif
-
 using std::cerr;
 using std::endl;
 
@@ -140,65 +133,124 @@ std::ostream &operator<<(std::ostream &out, const RealTime &rt)
     return out;
 }
 
-std::string
-RealTime::toString() const
+// Helpers for the allocation-free formatters.  put() stops writing
+// one short of size so there is always room for the terminator, and
+// len counts only what was written.
+
+static void
+put(char *buffer, int size, int &len, char c)
 {
-    std::stringstream out;
-    out << *this;
-    
-    std::string s = out.str();
+    if (len < size - 1) buffer[len++] = c;
+}
 
-    // remove trailing R
-    return s.substr(0, s.length() - 1);
+static void
+putNumber(char *buffer, int size, int &len, unsigned int n, int minDigits)
+{
+    char digits[16];
+    int count = 0;
+    do {
+        digits[count++] = char('0' + n % 10);
+        n /= 10;
+    } while (n > 0);
+    while (count < minDigits) digits[count++] = '0';
+    while (count > 0) put(buffer, size, len, digits[--count]);
+}
+
+int
+RealTime::toString(char *buffer, int size) const
+{
+    if (size <= 0) return 0;
+
+    int len = 0;
+
+    put(buffer, size, len, (*this < RealTime::zeroTime) ? '-' : ' ');
+
+    unsigned int s = (sec < 0 ? 0u - unsigned(sec) : unsigned(sec));
+    unsigned int n = (nsec < 0 ? 0u - unsigned(nsec) : unsigned(nsec));
+
+    putNumber(buffer, size, len, s, 1);
+    put(buffer, size, len, '.');
+    putNumber(buffer, size, len, n, 9);
+
+    buffer[len] = '\0';
+    return len;
 }
 
 std::string
-RealTime::toText(bool fixedDp) const
+RealTime::toString() const
 {
-    if (*this < RealTime::zeroTime) return "-" + (-*this).toText(fixedDp);
+    char buffer[32];
+    toString(buffer, sizeof(buffer));
+    return buffer;
+}
 
-    std::stringstream out;
+int
+RealTime::toText(char *buffer, int size, bool fixedDp) const
+{
+    if (size <= 0) return 0;
+
+    if (*this < RealTime::zeroTime) {
+        if (size == 1) {
+            buffer[0] = '\0';
+            return 0;
+        }
+        buffer[0] = '-';
+        return 1 + (-*this).toText(buffer + 1, size - 1, fixedDp);
+    }
+
+    int len = 0;
 
     if (sec >= 3600) {
-        out << (sec / 3600) << ":";
+        putNumber(buffer, size, len, sec / 3600, 1);
+        put(buffer, size, len, ':');
     }
-    
+
     if (sec >= 60) {
         int minutes = (sec % 3600) / 60;
-        if (sec >= 3600 && minutes < 10) out << "0";
-        out << minutes << ":";
+        putNumber(buffer, size, len, minutes, sec >= 3600 ? 2 : 1);
+        put(buffer, size, len, ':');
     }
-    
+
     if (sec >= 10) {
-        out << ((sec % 60) / 10);
+        put(buffer, size, len, char('0' + (sec % 60) / 10));
     }
-    
-    out << (sec % 10);
-    
+
+    put(buffer, size, len, char('0' + sec % 10));
+
     int ms = msec();
 
     if (ms != 0) {
-	out << ".";
-	out << (ms / 100);
-	ms = ms % 100;
-	if (ms != 0) {
-	    out << (ms / 10);
-	    ms = ms % 10;
-	} else if (fixedDp) {
-	    out << "0";
-	}
-	if (ms != 0) {
-	    out << ms;
-	} else if (fixedDp) {
-	    out << "0";
-	}
+        put(buffer, size, len, '.');
+        put(buffer, size, len, char('0' + ms / 100));
+        ms = ms % 100;
+        if (ms != 0) {
+            put(buffer, size, len, char('0' + ms / 10));
+            ms = ms % 10;
+        } else if (fixedDp) {
+            put(buffer, size, len, '0');
+        }
+        if (ms != 0) {
+            put(buffer, size, len, char('0' + ms));
+        } else if (fixedDp) {
+            put(buffer, size, len, '0');
+        }
     } else if (fixedDp) {
-	out << ".000";
+        put(buffer, size, len, '.');
+        put(buffer, size, len, '0');
+        put(buffer, size, len, '0');
+        put(buffer, size, len, '0');
     }
-	
-    std::string s = out.str();
 
-    return s;
+    buffer[len] = '\0';
+    return len;
+}
+
+std::string
+RealTime::toText(bool fixedDp) const
+{
+    char buffer[32];
+    toText(buffer, sizeof(buffer), fixedDp);
+    return buffer;
 }
 
 RealTime
@@ -222,12 +274,15 @@ RealTime::operator/(const RealTime &r) const
     else return lTotal/rTotal;
 }
 
+// Frame conversions round to nearest using integer arithmetic only:
+// (x + d/2) / d is x/d rounded half up for non-negative x.
+
 long
 RealTime::realTime2Frame(const RealTime &time, unsigned int sampleRate)
 {
     if (time < zeroTime) return -realTime2Frame(-time, sampleRate);
-    double s = time.sec + double(time.nsec) / ONE_BILLION;
-    return long(s * sampleRate + 0.5);
+    long long frame = (long long)time.nsec * sampleRate + ONE_BILLION / 2;
+    return long(time.sec) * long(sampleRate) + long(frame / ONE_BILLION);
 }
 
 RealTime
@@ -237,11 +292,28 @@ RealTime::frame2RealTime(long frame, unsigned int sampleRate)
 
     int sec = int(frame / long(sampleRate));
     frame -= sec * long(sampleRate);
-    int nsec = (int)((double(frame) / double(sampleRate)) * ONE_BILLION + 0.5);
+    long long nsec = (long long)frame * ONE_BILLION + sampleRate / 2;
     // Use ctor here instead of setting data members directly to
     // ensure nsec > ONE_BILLION is handled properly.  It's extremely
     // unlikely, but not impossible.
-    return RealTime(sec, nsec);
+    return RealTime(sec, int(nsec / sampleRate));
+}
+
+RealTime::FrameConverter::FrameConverter(unsigned int sampleRate) :
+    m_rate(sampleRate),
+    m_num(ONE_BILLION),
+    m_den(sampleRate)
+{
+    long long a = m_num, b = m_den;
+    while (b != 0) {
+        long long t = a % b;
+        a = b;
+        b = t;
+    }
+    if (a > 1) {
+        m_num /= a;
+        m_den /= a;
+    }
 }
 
 const RealTime RealTime::zeroTime(0,0);
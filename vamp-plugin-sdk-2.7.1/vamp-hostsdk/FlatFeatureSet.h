@@ -0,0 +1,180 @@
+/* -*- c-basic-offset: 4 indent-tabs-mode: nil -*-  vi:set ts=8 sts=4 sw=4: */
+
+/*
+    Vamp
+
+    An API for audio analysis and feature extraction plugins.
+
+    Centre for Digital Music, Queen Mary, University of London.
+    Copyright 2006-2009 Chris Cannam and QMUL.
+  
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without
+    restriction, including without limitation the rights to use, copy,
+    modify, merge, publish, distribute, sublicense, and/or sell copies
+    of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR
+    ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+    CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+    Except as contained in this notice, the names of the Centre for
+    Digital Music; Queen Mary, University of London; and Chris Cannam
+    shall not be used in advertising or otherwise to promote the sale,
+    use or other dealings in this Software without prior written
+    authorization.
+*/
+
+#ifndef _VAMP_FLAT_FEATURE_SET_H_
+#define _VAMP_FLAT_FEATURE_SET_H_
+
+#include "hostguard.h"
+#include "RealTime.h"
+
+#include <vector>
+
+_VAMP_SDK_HOSTSPACE_BEGIN(FlatFeatureSet.h)
+
+namespace Vamp {
+
+/**
+ * \class FlatFeatureSet FlatFeatureSet.h <vamp-hostsdk/FlatFeatureSet.h>
+ * 
+ * FlatFeatureSet is a read-only view of the features returned from a
+ * single process or getRemainingFeatures call, as one contiguous
+ * array of FlatFeatureSet::Feature records per output.  The values
+ * and labels are not copied: they point straight into the feature
+ * lists the plugin returned through the C API.  Once its internal
+ * arrays have grown to size, filling one allocates nothing, unlike
+ * building a Plugin::FeatureSet.
+ *
+ * A FlatFeatureSet is only valid until the next call to the plugin
+ * object that returned it.
+ *
+ * See FlatFeatureSource for how to obtain one.
+ */
+
+class FlatFeatureSet
+{
+public:
+    struct Feature {
+        bool hasTimestamp;
+        RealTime timestamp;
+        bool hasDuration;
+        RealTime duration;
+        unsigned int valueCount;
+        const float *values;
+        const char *label; // 0 if the feature has no label
+    };
+
+    FlatFeatureSet() : m_offsets(1, 0) { }
+
+    /**
+     * Return the number of outputs the set covers.  Outputs are
+     * numbered as in Plugin::FeatureSet.
+     */
+    unsigned int getOutputCount() const {
+        return (unsigned int)m_offsets.size() - 1;
+    }
+
+    /**
+     * Return the number of features returned on the given output.
+     */
+    unsigned int getFeatureCount(int output) const {
+        if (output < 0 || output >= int(getOutputCount())) return 0;
+        return m_offsets[output + 1] - m_offsets[output];
+    }
+
+    /**
+     * Return the features returned on the given output, an array of
+     * getFeatureCount(output) records, or 0 if there are none.
+     */
+    const Feature *getFeatures(int output) const {
+        if (getFeatureCount(output) == 0) return 0;
+        return &m_features[m_offsets[output]];
+    }
+
+    /**
+     * For implementations: empty the set, keeping its storage.
+     */
+    void clear() {
+        m_features.clear();
+        m_offsets.resize(1);
+    }
+
+    /**
+     * For implementations: start the next output.
+     */
+    void beginOutput() {
+        m_offsets.push_back(m_offsets.back());
+    }
+
+    /**
+     * For implementations: add a feature to the output most recently
+     * begun.
+     */
+    void addFeature(const Feature &feature) {
+        m_features.push_back(feature);
+        ++m_offsets.back();
+    }
+
+protected:
+    std::vector<Feature> m_features;
+    std::vector<unsigned int> m_offsets;
+};
+
+/**
+ * \class FlatFeatureSource FlatFeatureSet.h <vamp-hostsdk/FlatFeatureSet.h>
+ * 
+ * FlatFeatureSource is implemented by plugin objects that can return
+ * their features as a FlatFeatureSet instead of a Plugin::FeatureSet.
+ * PluginHostAdapter always can.  Wrappers that pass features through
+ * unchanged (PluginInputDomainAdapter, PluginChannelAdapter and the
+ * wrapper PluginLoader adds to every plugin) can if the plugin they
+ * wrap can; the buffering and summarising adapters can't.
+ *
+ * A host that only needs the numbers can do this with a plugin
+ * obtained from PluginLoader:
+ *
+ * \code
+ * FlatFeatureSource *flat = dynamic_cast<FlatFeatureSource *>(plugin);
+ * if (flat && flat->hasFlatFeatures()) {
+ *     const FlatFeatureSet &fs = flat->processFlat(buffers, timestamp);
+ *     ...
+ * }
+ * \endcode
+ *
+ * processFlat takes the place of a call to process, and
+ * getRemainingFeaturesFlat of a call to getRemainingFeatures; a host
+ * may use either form for any call.  Calling processFlat on an object
+ * for which hasFlatFeatures returns false returns an empty set
+ * without processing anything.
+ */
+
+class FlatFeatureSource
+{
+public:
+    virtual ~FlatFeatureSource() { }
+
+    virtual bool hasFlatFeatures() const = 0;
+
+    virtual const FlatFeatureSet &processFlat(const float *const *inputBuffers,
+                                              RealTime timestamp) = 0;
+
+    virtual const FlatFeatureSet &getRemainingFeaturesFlat() = 0;
+};
+
+}
+
+_VAMP_SDK_HOSTSPACE_END(FlatFeatureSet.h)
+
+#endif
@@ -0,0 +1,338 @@
+/* -*- c-basic-offset: 4 indent-tabs-mode: nil -*-  vi:set ts=8 sts=4 sw=4: */
+
+/*
+    Vamp
+
+    An API for audio analysis and feature extraction plugins.
+
+    Centre for Digital Music, Queen Mary, University of London.
+    Copyright 2006-2009 Chris Cannam and QMUL.
+  
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without
+    restriction, including without limitation the rights to use, copy,
+    modify, merge, publish, distribute, sublicense, and/or sell copies
+    of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR
+    ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+    CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+    Except as contained in this notice, the names of the Centre for
+    Digital Music; Queen Mary, University of London; and Chris Cannam
+    shall not be used in advertising or otherwise to promote the sale,
+    use or other dealings in this Software without prior written
+    authorization.
+*/
+
+#ifndef _VAMP_PLUGIN_ADAPTER_CHAIN_H_
+#define _VAMP_PLUGIN_ADAPTER_CHAIN_H_
+
+#include "hostguard.h"
+#include "PluginWrapper.h"
+#include "PluginInputDomainAdapter.h"
+#include "PluginChannelAdapter.h"
+#include "FlatFeatureSet.h"
+
+_VAMP_SDK_HOSTSPACE_BEGIN(PluginAdapterChain.h)
+
+namespace Vamp {
+
+namespace HostExt {
+
+/**
+ * \class PluginStage PluginAdapterChain.h <vamp-hostsdk/PluginAdapterChain.h>
+ *
+ * The innermost stage of a PluginAdapterChain, which calls the
+ * plugin itself.
+ *
+ * A stage is constructed from the plugin and its input sample rate
+ * and has the same initialise, reset, process and processFlat calls
+ * as a plugin, none of them virtual.  Each stage other than this one
+ * holds the next by value and hands it its input buffers directly,
+ * so a chain of stages compiles down to the conversions themselves
+ * with a single call into the plugin at the end.
+ */
+
+class PluginStage
+{
+public:
+    PluginStage(Plugin *plugin, float) :
+        m_plugin(plugin),
+        m_flat(dynamic_cast<FlatFeatureSource *>(plugin)) {
+        if (m_flat && !m_flat->hasFlatFeatures()) m_flat = 0;
+    }
+
+    Plugin *getPlugin() const { return m_plugin; }
+
+    Plugin::InputDomain getInputDomain() const {
+        return m_plugin->getInputDomain();
+    }
+    size_t getPreferredStepSize() const {
+        return m_plugin->getPreferredStepSize();
+    }
+    size_t getPreferredBlockSize() const {
+        return m_plugin->getPreferredBlockSize();
+    }
+    RealTime getTimestampAdjustment() const {
+        return RealTime::zeroTime;
+    }
+
+    bool initialise(size_t channels, size_t stepSize, size_t blockSize) {
+        return m_plugin->initialise(channels, stepSize, blockSize);
+    }
+    void reset() {
+        m_plugin->reset();
+    }
+
+    Plugin::FeatureSet process(const float *const *inputBuffers,
+                               RealTime timestamp) {
+        return m_plugin->process(inputBuffers, timestamp);
+    }
+
+    bool hasFlatFeatures() const {
+        return m_flat != 0;
+    }
+    const FlatFeatureSet &processFlat(const float *const *inputBuffers,
+                                      RealTime timestamp) {
+        return m_flat->processFlat(inputBuffers, timestamp);
+    }
+
+protected:
+    Plugin *m_plugin;
+    FlatFeatureSource *m_flat;
+};
+
+/**
+ * \class InputDomainStage PluginAdapterChain.h <vamp-hostsdk/PluginAdapterChain.h>
+ *
+ * A PluginAdapterChain stage that does what PluginInputDomainAdapter
+ * does, using an InputDomainConverter, before passing its input on
+ * to the Next stage.
+ */
+
+template <typename Next>
+class InputDomainStage
+{
+public:
+    InputDomainStage(Plugin *plugin, float inputSampleRate) :
+        m_converter(plugin, inputSampleRate),
+        m_next(plugin, inputSampleRate) { }
+
+    Plugin *getPlugin() const { return m_next.getPlugin(); }
+
+    InputDomainConverter &getConverter() { return m_converter; }
+    Next &getNext() { return m_next; }
+
+    Plugin::InputDomain getInputDomain() const {
+        return Plugin::TimeDomain;
+    }
+    size_t getPreferredStepSize() const {
+        return m_converter.getPreferredStepSize();
+    }
+    size_t getPreferredBlockSize() const {
+        return m_converter.getPreferredBlockSize();
+    }
+    RealTime getTimestampAdjustment() const {
+        return m_converter.getTimestampAdjustment() +
+            m_next.getTimestampAdjustment();
+    }
+
+    bool initialise(size_t channels, size_t stepSize, size_t blockSize) {
+        if (!m_converter.initialise(channels, stepSize, blockSize)) {
+            return false;
+        }
+        return m_next.initialise(channels, stepSize, blockSize);
+    }
+    void reset() {
+        m_converter.reset();
+        m_next.reset();
+    }
+
+    Plugin::FeatureSet process(const float *const *inputBuffers,
+                               RealTime timestamp) {
+        const float *const *buffers =
+            m_converter.convert(inputBuffers, timestamp);
+        return m_next.process(buffers, timestamp);
+    }
+
+    bool hasFlatFeatures() const {
+        return m_next.hasFlatFeatures();
+    }
+    const FlatFeatureSet &processFlat(const float *const *inputBuffers,
+                                      RealTime timestamp) {
+        const float *const *buffers =
+            m_converter.convert(inputBuffers, timestamp);
+        return m_next.processFlat(buffers, timestamp);
+    }
+
+protected:
+    InputDomainConverter m_converter;
+    Next m_next;
+};
+
+/**
+ * \class ChannelStage PluginAdapterChain.h <vamp-hostsdk/PluginAdapterChain.h>
+ *
+ * A PluginAdapterChain stage that does what PluginChannelAdapter
+ * does, using a ChannelMixer, before passing its input on to the
+ * Next stage.
+ */
+
+template <typename Next>
+class ChannelStage
+{
+public:
+    ChannelStage(Plugin *plugin, float inputSampleRate) :
+        m_next(plugin, inputSampleRate) { }
+
+    Plugin *getPlugin() const { return m_next.getPlugin(); }
+
+    ChannelMixer &getMixer() { return m_mixer; }
+    Next &getNext() { return m_next; }
+
+    Plugin::InputDomain getInputDomain() const {
+        return m_next.getInputDomain();
+    }
+    size_t getPreferredStepSize() const {
+        return m_next.getPreferredStepSize();
+    }
+    size_t getPreferredBlockSize() const {
+        return m_next.getPreferredBlockSize();
+    }
+    RealTime getTimestampAdjustment() const {
+        return m_next.getTimestampAdjustment();
+    }
+
+    bool initialise(size_t channels, size_t stepSize, size_t blockSize) {
+        Plugin *plugin = getPlugin();
+        size_t pluginChannels = m_mixer.initialise
+            (channels, plugin->getMinChannelCount(),
+             plugin->getMaxChannelCount(), blockSize);
+        return m_next.initialise(pluginChannels, stepSize, blockSize);
+    }
+    void reset() {
+        m_next.reset();
+    }
+
+    Plugin::FeatureSet process(const float *const *inputBuffers,
+                               RealTime timestamp) {
+        return m_next.process(m_mixer.mix(inputBuffers), timestamp);
+    }
+
+    bool hasFlatFeatures() const {
+        return m_next.hasFlatFeatures();
+    }
+    const FlatFeatureSet &processFlat(const float *const *inputBuffers,
+                                      RealTime timestamp) {
+        return m_next.processFlat(m_mixer.mix(inputBuffers), timestamp);
+    }
+
+protected:
+    ChannelMixer m_mixer;
+    Next m_next;
+};
+
+/**
+ * \class PluginAdapterChain PluginAdapterChain.h <vamp-hostsdk/PluginAdapterChain.h>
+ *
+ * PluginAdapterChain is a plugin wrapper that runs a pipeline of
+ * adapter stages fixed at compile time, such as
+ * ChannelStage<InputDomainStage<PluginStage> >, in place of a stack
+ * of separately allocated adapters.  A process call costs one virtual
+ * call into the chain and one out of it into the plugin; everything
+ * between is inlined, and a stage with nothing to do passes the
+ * host's buffers on untouched.
+ *
+ * Wrap a plugin loaded without adapters:
+ *
+ * \code
+ * Plugin *plugin = new InputAdapterChain(loader->loadPlugin(key, rate, 0));
+ * \endcode
+ *
+ * The chain takes ownership of the plugin.  Hosts that need the
+ * buffering adapter, or to mix chains and runtime adapters, can go on
+ * using PluginLoader's adapter flags as before.
+ */
+
+template <typename Stages>
+class PluginAdapterChain : public PluginWrapper
+{
+public:
+    PluginAdapterChain(Plugin *plugin) :
+        PluginWrapper(plugin),
+        m_stages(plugin, m_inputSampleRate) { }
+
+    bool initialise(size_t channels, size_t stepSize, size_t blockSize) {
+        return m_stages.initialise(channels, stepSize, blockSize);
+    }
+    void reset() {
+        m_stages.reset();
+    }
+
+    InputDomain getInputDomain() const {
+        return m_stages.getInputDomain();
+    }
+
+    size_t getPreferredStepSize() const {
+        return m_stages.getPreferredStepSize();
+    }
+    size_t getPreferredBlockSize() const {
+        return m_stages.getPreferredBlockSize();
+    }
+
+    FeatureSet process(const float *const *inputBuffers, RealTime timestamp) {
+        return m_stages.process(inputBuffers, timestamp);
+    }
+
+    bool hasFlatFeatures() const {
+        return m_stages.hasFlatFeatures();
+    }
+    const FlatFeatureSet &processFlat(const float *const *inputBuffers,
+                                      RealTime timestamp) {
+        if (!hasFlatFeatures()) return m_noFeatures;
+        return m_stages.processFlat(inputBuffers, timestamp);
+    }
+
+    /**
+     * Return the total timestamp adjustment made by the stages, as
+     * for PluginInputDomainAdapter::getTimestampAdjustment.
+     */
+    RealTime getTimestampAdjustment() const {
+        return m_stages.getTimestampAdjustment();
+    }
+
+    /**
+     * Return the outermost stage, for access to the stage-specific
+     * settings (such as the window type of an InputDomainStage).
+     */
+    Stages &getStages() { return m_stages; }
+
+protected:
+    Stages m_stages;
+};
+
+/**
+ * The chain equivalent of loading with ADAPT_INPUT_DOMAIN |
+ * ADAPT_CHANNEL_COUNT: channel mixing, then conversion to the
+ * plugin's input domain.
+ */
+typedef PluginAdapterChain<ChannelStage<InputDomainStage<PluginStage> > >
+InputAdapterChain;
+
+}
+
+}
+
+_VAMP_SDK_HOSTSPACE_END(PluginAdapterChain.h)
+
+#endif
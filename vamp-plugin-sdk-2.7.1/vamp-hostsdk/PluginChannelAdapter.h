@@ -124,6 +124,11 @@ public:
 
     FeatureSet process(const float *const *inputBuffers, RealTime timestamp);
 
+    bool hasFlatFeatures() const;
+
+    const FlatFeatureSet &processFlat(const float *const *inputBuffers,
+                                      RealTime timestamp);
+
     /**
      * Call process(), providing interleaved audio data with the
      * number of channels passed to initialise().  The adapter will
@@ -140,6 +145,52 @@ protected:
     Impl *m_impl;
 };
 
+/**
+ * \class ChannelMixer PluginChannelAdapter.h <vamp-hostsdk/PluginChannelAdapter.h>
+ *
+ * ChannelMixer is the channel policy PluginChannelAdapter applies to
+ * its input, separated from the plugin wrapper so that it can be used
+ * as a stage in a PluginAdapterChain.  It prepares the buffers to
+ * pass to a plugin's process() in place of the ones the host has,
+ * but does not call the plugin itself.
+ */
+
+class ChannelMixer
+{
+public:
+    ChannelMixer();
+    ~ChannelMixer();
+
+    /**
+     * Prepare to adapt blocks of the given number of input channels
+     * for a plugin accepting between minChannels and maxChannels.
+     * Returns the number of channels to initialise the plugin with.
+     */
+    size_t initialise(size_t inputChannels,
+                      size_t minChannels, size_t maxChannels,
+                      size_t blockSize);
+
+    /**
+     * Return the buffers to pass to the plugin for the given input.
+     * These are either the input buffers themselves or buffers owned
+     * by the mixer, valid until the next call.
+     */
+    const float *const *mix(const float *const *inputBuffers);
+
+    /**
+     * As mix(), but for interleaved input.
+     */
+    const float *const *mixInterleaved(const float *inputBuffer);
+
+protected:
+    class Impl;
+    Impl *m_impl;
+
+private:
+    ChannelMixer(const ChannelMixer &);
+    ChannelMixer &operator=(const ChannelMixer &);
+};
+
 }
 
 }
@@ -39,6 +39,7 @@
 
 #include "hostguard.h"
 #include "Plugin.h"
+#include "FlatFeatureSet.h"
 
 #include <vamp/vamp.h>
 
@@ -63,9 +64,13 @@ namespace Vamp {
  *
  * See also PluginAdapter, the plugin-side wrapper that makes a C++
  * plugin object available using the C query API.
+ *
+ * PluginHostAdapter is also a FlatFeatureSource, so a host can take
+ * the plugin's features as a FlatFeatureSet view of the plugin's own
+ * feature lists rather than having them converted into a FeatureSet.
  */
 
-class PluginHostAdapter : public Plugin
+class PluginHostAdapter : public Plugin, public FlatFeatureSource
 {
 public:
     PluginHostAdapter(const VampPluginDescriptor *descriptor,
@@ -107,11 +112,34 @@ public:
 
     FeatureSet getRemainingFeatures();
 
+    bool hasFlatFeatures() const;
+
+    const FlatFeatureSet &processFlat(const float *const *inputBuffers,
+                                      RealTime timestamp);
+
+    const FlatFeatureSet &getRemainingFeaturesFlat();
+
 protected:
     void convertFeatures(VampFeatureList *, FeatureSet &);
+    void convertFeatures(VampFeatureList *, FlatFeatureSet &);
+    void releaseFlatFeatures();
+    unsigned int getOutputCount() const;
+    void invalidateOutputs();
 
     const VampPluginDescriptor *m_descriptor;
     VampPluginHandle m_handle;
+
+    // The converted output descriptors and the output count, fetched
+    // on first use and kept until a call that could change them
+    mutable OutputList m_outputs;
+    mutable bool m_haveOutputs;
+    mutable unsigned int m_outputCount;
+    mutable bool m_haveOutputCount;
+
+    // The feature lists m_flatFeatures points into, held until the
+    // next call that could invalidate them
+    VampFeatureList *m_heldFeatures;
+    FlatFeatureSet m_flatFeatures;
 };
 
 }
@@ -105,6 +105,11 @@ public:
 
     FeatureSet process(const float *const *inputBuffers, RealTime timestamp);
 
+    bool hasFlatFeatures() const;
+
+    const FlatFeatureSet &processFlat(const float *const *inputBuffers,
+                                      RealTime timestamp);
+
     /**
      * ProcessTimestampMethod determines how the
      * PluginInputDomainAdapter handles timestamps for the data passed
@@ -227,6 +232,68 @@ protected:
     Impl *m_impl;
 };
 
+/**
+ * \class InputDomainConverter PluginInputDomainAdapter.h <vamp-hostsdk/PluginInputDomainAdapter.h>
+ *
+ * InputDomainConverter is the conversion PluginInputDomainAdapter
+ * applies to its input, separated from the plugin wrapper so that it
+ * can be used as a stage in a PluginAdapterChain.  It prepares the
+ * buffers and timestamp to pass to a plugin's process() in place of
+ * the time-domain ones the host has, but does not call the plugin
+ * itself.  The plugin given on construction is only asked about its
+ * input domain and preferred step and block sizes.
+ *
+ * See PluginInputDomainAdapter for the meaning of the timestamp
+ * methods, window types and preferred sizes.
+ */
+
+class InputDomainConverter
+{
+public:
+    InputDomainConverter(Plugin *plugin, float inputSampleRate);
+    ~InputDomainConverter();
+
+    /**
+     * Prepare to convert blocks of the given size.  Returns false if
+     * the block size can't be used, in which case the plugin should
+     * not be initialised either.
+     */
+    bool initialise(size_t channels, size_t stepSize, size_t blockSize);
+
+    /**
+     * Start again from the first block, as for Plugin::reset().
+     */
+    void reset();
+
+    size_t getPreferredStepSize() const;
+    size_t getPreferredBlockSize() const;
+
+    /**
+     * Return the buffers to pass to the plugin for the given
+     * time-domain input, adjusting timestamp to match.  For a
+     * time-domain plugin this is inputBuffers itself; otherwise it is
+     * owned by the converter and valid until the next call.
+     */
+    const float *const *convert(const float *const *inputBuffers,
+                                RealTime &timestamp);
+
+    void setProcessTimestampMethod(PluginInputDomainAdapter::ProcessTimestampMethod);
+    PluginInputDomainAdapter::ProcessTimestampMethod getProcessTimestampMethod() const;
+
+    RealTime getTimestampAdjustment() const;
+
+    PluginInputDomainAdapter::WindowType getWindowType() const;
+    void setWindowType(PluginInputDomainAdapter::WindowType type);
+
+protected:
+    class Impl;
+    Impl *m_impl;
+
+private:
+    InputDomainConverter(const InputDomainConverter &);
+    InputDomainConverter &operator=(const InputDomainConverter &);
+};
+
 }
 
 }
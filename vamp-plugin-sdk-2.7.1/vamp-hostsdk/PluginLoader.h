@@ -43,6 +43,7 @@
 
 #include "hostguard.h"
 #include "PluginWrapper.h"
+#include "PluginStaticData.h"
 
 _VAMP_SDK_HOSTSPACE_BEGIN(PluginLoader.h)
 
@@ -66,6 +67,20 @@ namespace HostExt {
  * class, and are certainly not required to use this actual class.
  * But we do strongly recommend it.
  *
+ * PluginLoader keeps an on-disk index of the plugins found in each
+ * library, keyed by library path and checked against the library's
+ * modification time and size.  Listing plugins, resolving plugin
+ * keys and querying static plugin data only open libraries that are
+ * new or have changed since they were last indexed.  The index is
+ * kept in the user's cache directory; set VAMP_INDEX_PATH to use a
+ * different file, or to an empty string to disable it.
+ *
+ * The plugin path directories are listed, and libraries that need
+ * indexing are probed, concurrently on a few worker threads (see
+ * VAMP_SCAN_THREADS), so that a scan takes about as long as its
+ * slowest library rather than the sum of all of them.  Results are
+ * always merged in plugin path order.
+ *
  * This class is not thread-safe; use it from a single application
  * thread, or guard access to it with a mutex.
  *
@@ -254,6 +269,19 @@ public:
      */
     std::string getLibraryPathForPlugin(PluginKey plugin);
 
+    /**
+     * Return the static data (metadata, parameters, default sizes,
+     * output descriptors and category) for a plugin, given its
+     * identifying key, without loading the plugin if its library is
+     * already indexed.
+     *
+     * If the plugin could not be found, returns a PluginStaticData
+     * with an empty pluginKey.
+     *
+     * \see PluginStaticData
+     */
+    PluginStaticData getPluginStaticData(PluginKey plugin);
+
 protected:
     PluginLoader();
     virtual ~PluginLoader();
@@ -0,0 +1,141 @@
+/* -*- c-basic-offset: 4 indent-tabs-mode: nil -*-  vi:set ts=8 sts=4 sw=4: */
+
+/*
+    Vamp
+
+    An API for audio analysis and feature extraction plugins.
+
+    Centre for Digital Music, Queen Mary, University of London.
+    Copyright 2006-2015 Chris Cannam and QMUL.
+  
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without
+    restriction, including without limitation the rights to use, copy,
+    modify, merge, publish, distribute, sublicense, and/or sell copies
+    of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR
+    ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+    CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+    Except as contained in this notice, the names of the Centre for
+    Digital Music; Queen Mary, University of London; and Chris Cannam
+    shall not be used in advertising or otherwise to promote the sale,
+    use or other dealings in this Software without prior written
+    authorization.
+*/
+
+#ifndef _VAMP_PLUGIN_STATIC_DATA_H_
+#define _VAMP_PLUGIN_STATIC_DATA_H_
+
+#include "hostguard.h"
+#include "Plugin.h"
+
+#include <string>
+#include <vector>
+
+_VAMP_SDK_HOSTSPACE_BEGIN(PluginStaticData.h)
+
+namespace Vamp {
+
+namespace HostExt {
+
+/**
+ * \class PluginStaticData PluginStaticData.h <vamp-hostsdk/PluginStaticData.h>
+ *
+ * PluginStaticData is a description of a plugin that can be obtained
+ * without loading it: its identifying metadata, parameters, programs,
+ * default sizes, channel limits and output descriptors, together
+ * with its category and the library it lives in.
+ *
+ * PluginLoader keeps these in its plugin index, so that hosts can
+ * list and describe plugins without opening their libraries.  See
+ * PluginLoader::getPluginStaticData().
+ *
+ * The output descriptors are those reported by an instance of the
+ * plugin constructed at referenceSampleRate and not yet initialised.
+ * A plugin whose outputs depend on sample rate or initialisation
+ * (bin count, fixed rates) may report different values once loaded
+ * and initialised; load it if exact values are needed.
+ */
+
+struct PluginStaticData
+{
+    std::string pluginKey;
+    std::string libraryPath;
+
+    unsigned int apiVersion;
+    std::string identifier;
+    std::string name;
+    std::string description;
+    std::string maker;
+    std::string copyright;
+    int pluginVersion;
+
+    std::vector<std::string> category;
+
+    Plugin::InputDomain inputDomain;
+    size_t preferredBlockSize;
+    size_t preferredStepSize;
+    size_t minChannelCount;
+    size_t maxChannelCount;
+
+    Plugin::ParameterList parameters;
+    Plugin::ProgramList programs;
+
+    float referenceSampleRate;
+    Plugin::OutputList outputs;
+
+    PluginStaticData() :
+        apiVersion(0), pluginVersion(0),
+        inputDomain(Plugin::TimeDomain),
+        preferredBlockSize(0), preferredStepSize(0),
+        minChannelCount(0), maxChannelCount(0),
+        referenceSampleRate(0.f) { }
+
+    /**
+     * Fill a PluginStaticData from a plugin instance that was
+     * constructed with the given input sample rate.  The category and
+     * library path are left for the caller to supply.
+     */
+    static PluginStaticData fromPlugin(std::string pluginKey,
+                                       const Plugin *plugin,
+                                       float inputSampleRate) {
+        PluginStaticData d;
+        d.pluginKey = pluginKey;
+        d.apiVersion = plugin->getVampApiVersion();
+        d.identifier = plugin->getIdentifier();
+        d.name = plugin->getName();
+        d.description = plugin->getDescription();
+        d.maker = plugin->getMaker();
+        d.copyright = plugin->getCopyright();
+        d.pluginVersion = plugin->getPluginVersion();
+        d.inputDomain = plugin->getInputDomain();
+        d.preferredBlockSize = plugin->getPreferredBlockSize();
+        d.preferredStepSize = plugin->getPreferredStepSize();
+        d.minChannelCount = plugin->getMinChannelCount();
+        d.maxChannelCount = plugin->getMaxChannelCount();
+        d.parameters = plugin->getParameterDescriptors();
+        d.programs = plugin->getPrograms();
+        d.referenceSampleRate = inputSampleRate;
+        d.outputs = plugin->getOutputDescriptors();
+        return d;
+    }
+};
+
+}
+
+}
+
+_VAMP_SDK_HOSTSPACE_END(PluginStaticData.h)
+
+#endif
@@ -39,6 +39,7 @@
 
 #include "hostguard.h"
 #include <vamp-hostsdk/Plugin.h>
+#include <vamp-hostsdk/FlatFeatureSet.h>
 
 _VAMP_SDK_HOSTSPACE_BEGIN(PluginWrapper.h)
 
@@ -56,10 +57,14 @@ namespace HostExt {
  * override only the methods that are meaningful for the particular
  * adapter.
  *
+ * The FlatFeatureSource methods delegate too, but hasFlatFeatures
+ * returns false unless a subclass that passes features through
+ * unchanged overrides it (see wrappedHasFlatFeatures).
+ *
  * \note This class was introduced in version 1.1 of the Vamp plugin SDK.
  */
 
-class PluginWrapper : public Plugin
+class PluginWrapper : public Plugin, public FlatFeatureSource
 {
 public:
     virtual ~PluginWrapper();
@@ -97,6 +102,13 @@ public:
 
     FeatureSet getRemainingFeatures();
 
+    bool hasFlatFeatures() const;
+
+    const FlatFeatureSet &processFlat(const float *const *inputBuffers,
+                                      RealTime timestamp);
+
+    const FlatFeatureSet &getRemainingFeaturesFlat();
+
     /**
      * Return a pointer to the plugin wrapper of type WrapperType
      * surrounding this wrapper's plugin, if present.
@@ -123,7 +135,22 @@ public:
 
 protected:
     PluginWrapper(Plugin *plugin); // I take ownership of plugin
+
+    /**
+     * Return the wrapped plugin as a FlatFeatureSource, or 0 if it
+     * can't return flat features.
+     */
+    FlatFeatureSource *getFlatSource() const;
+
+    /**
+     * Return true if the wrapped plugin can return flat features.  A
+     * subclass that passes features through unchanged can return this
+     * from hasFlatFeatures.
+     */
+    bool wrappedHasFlatFeatures() const;
+
     Plugin *m_plugin;
+    FlatFeatureSet m_noFeatures;
 };
 
 }
@@ -37,6 +37,7 @@
 #ifndef _VAMP_HOSTSDK_SINGLE_INCLUDE_H_
 #define _VAMP_HOSTSDK_SINGLE_INCLUDE_H_
 
+#include "PluginAdapterChain.h"
 #include "PluginBase.h"
 #include "PluginBufferingAdapter.h"
 #include "PluginChannelAdapter.h"
@@ -44,6 +45,7 @@
 #include "PluginHostAdapter.h"
 #include "PluginInputDomainAdapter.h"
 #include "PluginLoader.h"
+#include "PluginStaticData.h"
 #include "PluginSummarisingAdapter.h"
 #include "PluginWrapper.h"
 #include "RealTime.h"
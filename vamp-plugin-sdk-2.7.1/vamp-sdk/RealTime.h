@@ -139,12 +139,28 @@ struct RealTime
      */ 
     std::string toString() const;
 
+    /**
+     * Write the same string as toString() into a caller-supplied
+     * buffer, without allocating.  The result is truncated if it does
+     * not fit in size bytes including the terminating zero; 32 bytes
+     * is always enough.  Returns the number of characters written,
+     * not counting the terminator.
+     */
+    int toString(char *buffer, int size) const;
+
     /**
      * Return a user-readable string to the nearest millisecond
      * in a form like HH:MM:SS.mmm
      */
     std::string toText(bool fixedDp = false) const;
 
+    /**
+     * Write the same string as toText() into a caller-supplied
+     * buffer, without allocating.  Truncation and return value are as
+     * for toString(char *, int).
+     */
+    int toText(char *buffer, int size, bool fixedDp = false) const;
+
     /**
      * Convert a RealTime into a sample frame at the given sample rate.
      */
@@ -155,9 +171,47 @@ struct RealTime
      */
     static RealTime frame2RealTime(long frame, unsigned int sampleRate);
 
+    class FrameConverter;
+
     static const RealTime zeroTime;
 };
 
+/**
+ * \class RealTime::FrameConverter RealTime.h <vamp-sdk/RealTime.h>
+ *
+ * Converts between sample frames and RealTime at one fixed sample
+ * rate, for hosts and plugins that do so for every block or feature.
+ * The ratio of nanoseconds to frames is reduced to lowest terms on
+ * construction, and conversions use integer arithmetic only.
+ * Results are identical to RealTime::frame2RealTime and
+ * RealTime::realTime2Frame, which use the same rounding.
+ */
+class RealTime::FrameConverter
+{
+public:
+    FrameConverter(unsigned int sampleRate);
+
+    unsigned int getSampleRate() const { return m_rate; }
+
+    RealTime toRealTime(long frame) const {
+        if (frame < 0) return -toRealTime(-frame);
+        long sec = frame / long(m_rate);
+        long long rem = frame - sec * long(m_rate);
+        return RealTime(int(sec), int((rem * m_num + m_den / 2) / m_den));
+    }
+
+    long toFrame(const RealTime &r) const {
+        if (r < zeroTime) return -toFrame(-r);
+        return long(r.sec) * long(m_rate) +
+            long((r.nsec * m_den + m_num / 2) / m_num);
+    }
+
+private:
+    unsigned int m_rate;
+    long long m_num; // one frame is m_num / m_den nanoseconds
+    long long m_den;
+};
+
 std::ostream &operator<<(std::ostream &out, const RealTime &rt);
 
 }
@@ -0,0 +1,90 @@
+
+#include "viewfrustum.h"
+
+#include <cmath>
+
+viewFrustum::viewFrustum()
+{
+    //until take() is called everything is in view
+    for (int i = 0; i < 6; i++)
+    {
+        planes[i][0] = planes[i][1] = planes[i][2] = 0;
+        planes[i][3] = 1;
+    }
+    eye[0] = eye[1] = eye[2] = 0;
+}
+
+//the planes are sums and differences of the rows of projection times
+//modelview (Gribb and Hartmann); GL's matrices are column-major, so
+//row i column j is m[j * 4 + i]
+
+void viewFrustum::take()
+{
+    GLfloat p[16], mv[16], m[16];
+    glGetFloatv(GL_PROJECTION_MATRIX, p);
+    glGetFloatv(GL_MODELVIEW_MATRIX, mv);
+
+    for (int i = 0; i < 4; i++)
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            m[j * 4 + i] = 0;
+            for (int k = 0; k < 4; k++)
+            {
+                m[j * 4 + i] += p[k * 4 + i] * mv[j * 4 + k];
+            }
+        }
+    }
+
+    for (int plane = 0; plane < 6; plane++)
+    {
+        int row = plane / 2;
+        GLfloat sign = (plane % 2 == 0 ? 1 : -1);
+        for (int j = 0; j < 4; j++)
+        {
+            planes[plane][j] = m[j * 4 + 3] + sign * m[j * 4 + row];
+        }
+    }
+
+    //the modelview is a rotation R then a translation t, so the eye
+    //is at -R^T t
+    for (int j = 0; j < 3; j++)
+    {
+        eye[j] = 0;
+        for (int i = 0; i < 3; i++)
+        {
+            eye[j] -= mv[j * 4 + i] * mv[12 + i];
+        }
+    }
+}
+
+//a box is outside if its corner furthest along some plane's normal is
+//still behind that plane
+
+bool viewFrustum::intersects(const GLfloat *low, const GLfloat *high) const
+{
+    for (int plane = 0; plane < 6; plane++)
+    {
+        const GLfloat *n = planes[plane];
+        GLfloat d = n[3];
+        for (int j = 0; j < 3; j++)
+        {
+            d += n[j] * (n[j] >= 0 ? high[j] : low[j]);
+        }
+        if (d < 0) return false;
+    }
+    return true;
+}
+
+float viewFrustum::distanceTo(const GLfloat *low, const GLfloat *high) const
+{
+    float squared = 0;
+    for (int j = 0; j < 3; j++)
+    {
+        float d = 0;
+        if (eye[j] < low[j]) d = low[j] - eye[j];
+        else if (eye[j] > high[j]) d = eye[j] - high[j];
+        squared += d * d;
+    }
+    return std::sqrt(squared);
+}
@@ -0,0 +1,29 @@
+
+#ifndef VIEWFRUSTUM_H
+#define VIEWFRUSTUM_H
+
+#include <GL/gl.h>
+
+//The volume the camera can see, as six planes, and where the camera
+//is. take() reads both from the current projection and modelview
+//matrices, which reshape() and the gluLookAt from eyex, eyez, lon and
+//lat set up, so culling agrees exactly with what GL would draw.
+class viewFrustum {
+public:
+    viewFrustum();
+
+    //needs a current GL context
+    void take();
+
+    //false only if the box is wholly outside the view
+    bool intersects(const GLfloat *low, const GLfloat *high) const;
+
+    //how far the camera is from the nearest point of the box
+    float distanceTo(const GLfloat *low, const GLfloat *high) const;
+
+private:
+    GLfloat planes[6][4]; //a x + b y + c z + d >= 0 inside each
+    GLfloat eye[3];
+};
+
+#endif /* VIEWFRUSTUM_H */